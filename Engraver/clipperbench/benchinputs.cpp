@@ -0,0 +1,173 @@
+// benchinputs.cpp
+// Every input goes through the same code its tool uses to make it: levelset
+// for images, nanosvg for drawings, SliceIndex and buildLayerRegion for
+// meshes. Only the mesh is synthetic, so the suite needs no STL file.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#define NANOSVG_IMPLEMENTATION
+#include "nanosvg.h"
+#include "benchinputs.h"
+#include "layermodel.h"
+#include "levelset.h"
+#include "sliceindex.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+// Gear outline of the sliced part
+const int gear_teeth = 24;
+const int gear_steps = 720;          // ring vertices around the outline
+const double gear_radius = 40.0;     // mm
+const double tooth_depth = 3.0;      // mm
+const double gear_twist = 0.02;      // rad per mm of height
+const int bore_count = 8;
+const int bore_steps = 64;
+const double bore_ring = 26.0;       // mm, radius the bores sit on
+const double bore_radius = 6.0;      // mm
+const double layer_height = 0.2;     // mm
+
+// Adds the side wall between two rings of equal size; outward when the
+// rings run counter-clockwise seen from above.
+void addWall(const std::vector<QVector3D>& lower, const std::vector<QVector3D>& upper,
+             std::vector<Triangle>& tris) {
+    const size_t n = lower.size();
+    for (size_t i = 0; i < n; ++i) {
+        size_t j = (i + 1) % n;
+        tris.push_back({lower[i], lower[j], upper[j]});
+        tris.push_back({lower[i], upper[j], upper[i]});
+    }
+}
+
+std::vector<QVector3D> gearRing(float z) {
+    std::vector<QVector3D> ring;
+    ring.reserve(gear_steps);
+    for (int i = 0; i < gear_steps; ++i) {
+        double a = 2.0 * pi * i / gear_steps;
+        double r = gear_radius + tooth_depth * std::cos(gear_teeth * (a + gear_twist * z));
+        ring.emplace_back(float(r * std::cos(a)), float(r * std::sin(a)), z);
+    }
+    return ring;
+}
+
+// Clockwise, so the wall faces into the bore.
+std::vector<QVector3D> boreRing(int bore, float z) {
+    double centre = 2.0 * pi * bore / bore_count + gear_twist * z;
+    double cx = bore_ring * std::cos(centre), cy = bore_ring * std::sin(centre);
+    std::vector<QVector3D> ring;
+    ring.reserve(bore_steps);
+    for (int i = 0; i < bore_steps; ++i) {
+        double a = -2.0 * pi * i / bore_steps;
+        ring.emplace_back(float(cx + bore_radius * std::cos(a)), float(cy + bore_radius * std::sin(a)), z);
+    }
+    return ring;
+}
+
+// Steps a cubic needs to stay within tolerance of the curve: the chord of a
+// curve with second derivative at most M over a step h is off by M h^2 / 8.
+int cubicSteps(const float* p, double tolerance) {
+    double m = 0.0;
+    for (int k = 0; k < 2; ++k) {
+        double dx = p[2 * k] - 2.0 * p[2 * k + 2] + p[2 * k + 4];
+        double dy = p[2 * k + 1] - 2.0 * p[2 * k + 3] + p[2 * k + 5];
+        m = std::max(m, std::hypot(dx, dy));
+    }
+    return std::max(1, int(std::ceil(std::sqrt(6.0 * m / (8.0 * tolerance)))));
+}
+
+} // namespace
+
+Workload makeWorkload(const std::string& name, Paths64 subject) {
+    Workload work;
+    work.name = name;
+    Rect64 bounds = GetBounds(subject);
+    work.clip = TranslatePaths(subject, bounds.Width() / 9, bounds.Height() / 11);
+    work.subject = std::move(subject);
+    work.feature_mm = toMm(double(std::min(bounds.Width(), bounds.Height()))) / 200.0;
+    return work;
+}
+
+Paths64 tracedImage(const uint8_t* gray, int width, int height, int stride, int threshold,
+                    double pixel_size_mm) {
+    std::vector<uint8_t> lut = levelLookup({threshold});
+    LevelEdges edges = collectLevelEdges(gray, width, height, stride, lut, 1);
+    return traceLevel(edges.levels[0], width, pixel_size_mm);
+}
+
+Paths64 svgOutlines(const std::string& file, double tolerance_mm) {
+    Paths64 out;
+    NSVGimage* image = nsvgParseFromFile(file.c_str(), "mm", 96);
+    if (!image) return out;
+    for (NSVGshape* shape = image->shapes; shape; shape = shape->next) {
+        for (NSVGpath* path = shape->paths; path; path = path->next) {
+            PathD line;
+            line.emplace_back(path->pts[0], path->pts[1]);
+            for (int i = 0; i < path->npts - 1; i += 3) {
+                const float* p = &path->pts[i * 2];
+                int steps = cubicSteps(p, tolerance_mm);
+                for (int j = 1; j <= steps; ++j) {
+                    double t = double(j) / steps, it = 1.0 - t;
+                    line.emplace_back(it * it * it * p[0] + 3 * it * it * t * p[2] + 3 * it * t * t * p[4] + t * t * t * p[6],
+                                      it * it * it * p[1] + 3 * it * it * t * p[3] + 3 * it * t * t * p[5] + t * t * t * p[7]);
+                }
+            }
+            if (line.size() > 2) out.push_back(toUnits(line));
+        }
+    }
+    nsvgDelete(image);
+    return out;
+}
+
+Paths64 tiledCopies(const Paths64& paths, int cols, int rows, double pitch) {
+    Paths64 out;
+    out.reserve(paths.size() * cols * rows);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            Paths64 copy = TranslatePaths(paths, toUnits(c * pitch), toUnits(r * pitch));
+            out.insert(out.end(), std::make_move_iterator(copy.begin()), std::make_move_iterator(copy.end()));
+        }
+    }
+    return out;
+}
+
+Paths64 slicedLayers(int layer_count) {
+    // One ring per layer boundary; slicing midway between them keeps the
+    // planes off the vertices, as real layer heights mostly are.
+    std::vector<Triangle> tris;
+    std::vector<QVector3D> gear_below = gearRing(0.0f);
+    std::vector<std::vector<QVector3D>> bores_below;
+    for (int b = 0; b < bore_count; ++b) bores_below.push_back(boreRing(b, 0.0f));
+    for (int k = 1; k <= layer_count; ++k) {
+        float z = float(k * layer_height);
+        std::vector<QVector3D> gear = gearRing(z);
+        addWall(gear_below, gear, tris);
+        gear_below = std::move(gear);
+        for (int b = 0; b < bore_count; ++b) {
+            std::vector<QVector3D> bore = boreRing(b, z);
+            addWall(bores_below[b], bore, tris);
+            bores_below[b] = std::move(bore);
+        }
+    }
+
+    SliceIndex index;
+    index.build(tris);
+    Paths64 out;
+    for (int k = 0; k < layer_count; ++k) {
+        float z = float((k + 0.5) * layer_height);
+        LayerRegion layer = buildLayerRegion(index.slice(z), z);
+        out.insert(out.end(), layer.polygons.begin(), layer.polygons.end());
+    }
+    return out;
+}
+
+size_t vertexCount(const Paths64& paths) {
+    size_t n = 0;
+    for (const Path64& path : paths) n += path.size();
+    return n;
+}
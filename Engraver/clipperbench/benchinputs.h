@@ -0,0 +1,46 @@
+// benchinputs.h
+// The geometry the benchmark runs on: traced images, SVG drawings and sliced
+// mesh layers, as the tools in this repo feed them to Clipper
+
+#ifndef BENCHINPUTS_H
+#define BENCHINPUTS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "clipper2/clipper.h"
+#include "fixedpoint.h"
+
+// One input set, in fixed-point units. clip is the second operand of the
+// two-sided operations: the subject moved by a fraction of its size, so the
+// two overlap almost everywhere the way successive offsets or layers do.
+struct Workload {
+    std::string name;
+    Clipper2Lib::Paths64 subject;
+    Clipper2Lib::Paths64 clip;
+    double feature_mm = 1.0;   // offset distance and tool size for this input
+};
+
+// Gives the workload its clip and feature size; both scale with the bounds.
+Workload makeWorkload(const std::string& name, Clipper2Lib::Paths64 subject);
+
+// Pixel-boundary contours of the pixels at or below threshold, as greypocket
+// traces a level.
+Clipper2Lib::Paths64 tracedImage(const uint8_t* gray, int width, int height, int stride, int threshold,
+                                 double pixel_size_mm);
+
+// The closed outlines of an SVG drawing, curves flattened to tolerance_mm.
+// Empty when the file does not parse.
+Clipper2Lib::Paths64 svgOutlines(const std::string& file, double tolerance_mm);
+
+// Copies of paths on a cols x rows grid, pitch apart in both directions.
+Clipper2Lib::Paths64 tiledCopies(const Clipper2Lib::Paths64& paths, int cols, int rows, double pitch);
+
+// Cross-sections of a synthetic part, sliced the way slice2 slices an STL:
+// a twisted gear with a ring of bores, layer_count layers stacked into one
+// path set, as the undercut sweep's running union sees them.
+Clipper2Lib::Paths64 slicedLayers(int layer_count);
+
+size_t vertexCount(const Clipper2Lib::Paths64& paths);
+
+#endif // BENCHINPUTS_H
@@ -0,0 +1,116 @@
+// benchmark.cpp
+// Inputs are built before the clock starts and results are dropped after it
+// stops, so a run times the Clipper call alone. The median over the runs is
+// what gets compared; the minimum is kept to tell noise from a real change.
+
+#include "benchmark.h"
+#include "memtrack.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+const FillRule fill_rule = FillRule::NonZero;   // layers and tiled copies overlap
+const int tool_steps = 8;                       // sides of the Minkowski tool
+
+Path64 toolShape(double radius_mm) {
+    Path64 tool;
+    const double pi = 3.14159265358979323846;
+    for (int i = 0; i < tool_steps; ++i) {
+        double a = 2.0 * pi * i / tool_steps;
+        tool.emplace_back(toUnits(radius_mm * std::cos(a)), toUnits(radius_mm * std::sin(a)));
+    }
+    return tool;
+}
+
+Paths64 runOperation(const std::string& name, const Workload& work, const BenchSettings& settings,
+                     const Path64& tool) {
+    if (name == "inflate") {
+        return InflatePaths(work.subject, work.feature_mm * units_per_mm, JoinType::Round, EndType::Polygon,
+                            2.0, 0.0, settings.threads);
+    }
+    if (name == "union") {
+        return settings.threads > 1
+                   ? BooleanOpTiled(ClipType::Union, fill_rule, work.subject, work.clip, settings.threads)
+                   : Union(work.subject, work.clip, fill_rule);
+    }
+    if (name == "difference") {
+        return settings.threads > 1
+                   ? BooleanOpTiled(ClipType::Difference, fill_rule, work.subject, work.clip, settings.threads)
+                   : Difference(work.subject, work.clip, fill_rule);
+    }
+    if (name == "rectclip") {
+        Rect64 b = GetBounds(work.subject);
+        Rect64 middle(b.left + b.Width() / 4, b.top + b.Height() / 4, b.right - b.Width() / 4,
+                      b.bottom - b.Height() / 4);
+        return RectClip(middle, work.subject);
+    }
+    // minkowski: the sweep of each path is its own union, as a tool pass is
+    Paths64 out;
+    for (const Path64& path : work.subject) {
+        Paths64 swept = MinkowskiSum(tool, path, true);
+        out.insert(out.end(), std::make_move_iterator(swept.begin()), std::make_move_iterator(swept.end()));
+    }
+    return out;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+} // namespace
+
+const std::vector<std::string>& operationNames() {
+    static const std::vector<std::string> names = {"inflate", "union", "difference", "rectclip", "minkowski"};
+    return names;
+}
+
+std::vector<OpResult> runWorkload(const Workload& work, const BenchSettings& settings, const std::string& only) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<OpResult> results;
+    const Path64 tool = toolShape(work.feature_mm);
+    const size_t vertices_in = vertexCount(work.subject);
+
+    for (const std::string& name : operationNames()) {
+        std::string label = work.name + "/" + name;
+        if (!only.empty() && label.find(only) == std::string::npos) continue;
+
+        OpResult result;
+        result.workload = work.name;
+        result.operation = name;
+        result.vertices_in = vertices_in;
+        if (name == "union" || name == "difference") result.vertices_in += vertexCount(work.clip);
+
+        size_t base = heapInUse();
+        resetHeapPeak();
+        {
+            Paths64 out = runOperation(name, work, settings, tool);
+            result.peak_heap_bytes = heapPeak() - base;
+            result.vertices_out = vertexCount(out);
+        }
+
+        std::vector<double> times;
+        Clock::time_point start = Clock::now();
+        while (int(times.size()) < settings.max_runs) {
+            Paths64 out;
+            Clock::time_point t0 = Clock::now();
+            out = runOperation(name, work, settings, tool);
+            Clock::time_point t1 = Clock::now();
+            times.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+            double elapsed = std::chrono::duration<double>(t1 - start).count();
+            if (int(times.size()) >= settings.min_runs && elapsed >= settings.min_time_s) break;
+        }
+
+        result.runs = int(times.size());
+        result.median_ms = median(times);
+        result.min_ms = *std::min_element(times.begin(), times.end());
+        result.vertices_per_s = result.median_ms > 0.0 ? result.vertices_in / (result.median_ms / 1000.0) : 0.0;
+        results.push_back(result);
+    }
+    return results;
+}
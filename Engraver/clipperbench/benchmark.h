@@ -0,0 +1,44 @@
+// benchmark.h
+// Times the Clipper operations the tools lean on over one workload
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include "benchinputs.h"
+
+struct BenchSettings {
+    double min_time_s = 0.5;   // keep repeating an operation until this much time has passed...
+    int min_runs = 3;          // ...and it has run at least this often
+    int max_runs = 50;
+    unsigned threads = 1;      // for the operations that can split their work
+};
+
+struct OpResult {
+    std::string workload;
+    std::string operation;
+    int runs = 0;
+    double median_ms = 0.0;
+    double min_ms = 0.0;
+    size_t vertices_in = 0;
+    size_t vertices_out = 0;
+    double vertices_per_s = 0.0;   // vertices_in over the median time
+    size_t peak_heap_bytes = 0;    // heap the operation added at its high point
+};
+
+// The operations, in the order runWorkload runs them:
+// inflate     round offset of the subject by the workload's feature size
+// union       subject with clip
+// difference  subject minus clip
+// rectclip    subject clipped to the middle half of its bounds
+// minkowski   each subject path swept by a feature-sized octagon
+const std::vector<std::string>& operationNames();
+
+// Runs every operation whose name contains `only` (all when empty). Each one
+// runs once untimed to warm the allocator and caches, and that run gives the
+// output size and peak heap.
+std::vector<OpResult> runWorkload(const Workload& work, const BenchSettings& settings,
+                                  const std::string& only = std::string());
+
+#endif // BENCHMARK_H
@@ -0,0 +1,58 @@
+QT       += core gui
+
+CONFIG += c++17
+CONFIG += console
+CONFIG -= app_bundle
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+# The tools' own Clipper2 and geometry sources are compiled in, so what is
+# timed is what the tools run.
+SOURCES += \
+    benchinputs.cpp \
+    benchmark.cpp \
+    memtrack.cpp \
+    main.cpp \
+    ../greypocket/clipper.engine.cpp \
+    ../greypocket/clipper.offset.cpp \
+    ../greypocket/clipper.rectclip.cpp \
+    ../greypocket/clipper.tiled.cpp \
+    ../greypocket/levelset.cpp \
+    ../slice2/layermodel.cpp \
+    ../slice2/sliceindex.cpp
+
+HEADERS += \
+    benchinputs.h \
+    benchmark.h \
+    memtrack.h \
+    ../greypocket/fixedpoint.h \
+    ../greypocket/levelset.h \
+    ../greypocket/parallel.h \
+    ../slice2/layermodel.h \
+    ../slice2/sliceindex.h \
+    ../svg2gcode-qt/nanosvg.h
+
+INCLUDEPATH += ../greypocket ../slice2 ../svg2gcode-qt
+
+FORMS += \
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+RESOURCES +=
+
+
+LIBS += -L/Users/macbook2015/Desktop/brew/lib
+
+INCLUDEPATH += /Users/macbook2015/Desktop/brew/include /Users/macbook2015/Desktop/brew/lib
@@ -0,0 +1,205 @@
+// main.cpp
+// clipperbench: times the Clipper2 operations the tools use on inputs from
+// this repo, writes the figures as JSON and compares them with a baseline run
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <sys/resource.h>
+#include "benchinputs.h"
+#include "benchmark.h"
+#include "clipper2/clipper.version.h"
+
+using namespace Clipper2Lib;
+
+const int image_side = 1000;          // px, longest side the images are scaled to
+const int image_threshold = 128;      // gray at or below is traced
+const double pixel_size = 0.1;        // mm
+const double svg_tolerance = 0.01;    // mm, curve flattening
+const int svg_tiles = 6;              // copies per side
+const double svg_pitch = 0.75;        // of the drawing's size, so copies overlap
+const int layer_count = 16;
+
+static std::vector<Workload> loadWorkloads(const QDir& root) {
+    std::vector<Workload> works;
+
+    QDir images(root.filePath("linuxcnc-laser/graster/bin"));
+    for (const QString& name : images.entryList({"*.jpg", "*.png"}, QDir::Files, QDir::Name)) {
+        QImage image(images.filePath(name));
+        if (image.isNull()) continue;
+        if (std::max(image.width(), image.height()) > image_side)
+            image = image.scaled(image_side, image_side, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        image = image.convertToFormat(QImage::Format_Grayscale8);
+        Paths64 traced = tracedImage(image.constBits(), image.width(), image.height(), image.bytesPerLine(),
+                                     image_threshold, pixel_size);
+        if (!traced.empty())
+            works.push_back(makeWorkload("image:" + QFileInfo(name).baseName().toStdString(), std::move(traced)));
+    }
+
+    QDir drawings(root.filePath("Engraver/SvgOutline"));
+    for (const QString& name : drawings.entryList({"*.svg"}, QDir::Files, QDir::Name)) {
+        Paths64 outlines = svgOutlines(drawings.filePath(name).toStdString(), svg_tolerance);
+        if (outlines.empty()) continue;
+        Rect64 b = GetBounds(outlines);
+        double pitch = svg_pitch * toMm(double(std::max(b.Width(), b.Height())));
+        works.push_back(makeWorkload("svg:" + QFileInfo(name).baseName().toStdString(),
+                                     tiledCopies(outlines, svg_tiles, svg_tiles, pitch)));
+    }
+
+    works.push_back(makeWorkload("layers", slicedLayers(layer_count)));
+    return works;
+}
+
+// Peak resident set of the whole run in kB, inputs and Qt included.
+static long maxRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;   // bytes there
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+static QJsonObject toJson(const OpResult& r) {
+    QJsonObject o;
+    o["workload"] = QString::fromStdString(r.workload);
+    o["operation"] = QString::fromStdString(r.operation);
+    o["runs"] = r.runs;
+    o["median_ms"] = r.median_ms;
+    o["min_ms"] = r.min_ms;
+    o["vertices_in"] = double(r.vertices_in);
+    o["vertices_out"] = double(r.vertices_out);
+    o["vertices_per_s"] = r.vertices_per_s;
+    o["peak_heap_bytes"] = double(r.peak_heap_bytes);
+    return o;
+}
+
+// Prints each result against the baseline's and returns how many got slower
+// or hungrier than tolerance allows. A changed vertex count is reported but
+// not counted: it means Clipper's output changed, which needs a look, not
+// that it got slower.
+static int compareBaseline(const std::vector<OpResult>& results, const QJsonObject& baseline, unsigned threads,
+                           double tolerance) {
+    if (baseline["threads"].toInt() != int(threads))
+        std::fprintf(stderr, "warning: baseline ran on %d threads, this run on %u\n", baseline["threads"].toInt(),
+                     threads);
+
+    std::map<std::string, QJsonObject> base;
+    for (const QJsonValue& v : baseline["results"].toArray()) {
+        QJsonObject o = v.toObject();
+        base[(o["workload"].toString() + "/" + o["operation"].toString()).toStdString()] = o;
+    }
+
+    int regressions = 0;
+    std::printf("\n%-32s %10s %10s %7s %7s  %s\n", "vs baseline", "base ms", "ms", "time", "heap", "");
+    for (const OpResult& r : results) {
+        std::string key = r.workload + "/" + r.operation;
+        auto it = base.find(key);
+        if (it == base.end()) {
+            std::printf("%-32s %10s %10.2f %7s %7s  new\n", key.c_str(), "-", r.median_ms, "-", "-");
+            continue;
+        }
+        const QJsonObject& b = it->second;
+        double time_ratio = r.median_ms / std::max(b["median_ms"].toDouble(), 1e-6);
+        double heap_ratio = double(r.peak_heap_bytes) / std::max(b["peak_heap_bytes"].toDouble(), 1.0);
+        std::string notes;
+        if (time_ratio > 1.0 + tolerance) { notes += " SLOWER"; ++regressions; }
+        else if (time_ratio < 1.0 - tolerance) notes += " faster";
+        if (heap_ratio > 1.0 + tolerance) { notes += " MORE-HEAP"; ++regressions; }
+        if (double(r.vertices_out) != b["vertices_out"].toDouble())
+            notes += " output " + std::to_string(size_t(b["vertices_out"].toDouble())) + " -> " +
+                     std::to_string(r.vertices_out) + " vertices";
+        std::printf("%-32s %10.2f %10.2f %6.2fx %6.2fx %s\n", key.c_str(), b["median_ms"].toDouble(), r.median_ms,
+                    time_ratio, heap_ratio, notes.c_str());
+    }
+    return regressions;
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("clipperbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Clipper2 benchmark on traced images, SVG drawings and sliced layers");
+    parser.addHelpOption();
+    parser.addPositionalArgument("root", "Repository root the inputs are read from (default: current directory).");
+    QCommandLineOption outputOpt({"o", "output"}, "Write results to <file>.", "file", "clipperbench.json");
+    QCommandLineOption baselineOpt({"b", "baseline"}, "Compare with the results in <file>.", "file");
+    QCommandLineOption threadsOpt({"t", "threads"}, "Threads for inflate, union and difference.", "n", "1");
+    QCommandLineOption minTimeOpt("min-time", "Seconds to repeat each operation for.", "s", "0.5");
+    QCommandLineOption toleranceOpt("tolerance", "Slowdown or heap growth that counts as a regression.", "fraction",
+                                    "0.10");
+    QCommandLineOption onlyOpt("only", "Run only workload/operation names containing <text>.", "text");
+    parser.addOptions({outputOpt, baselineOpt, threadsOpt, minTimeOpt, toleranceOpt, onlyOpt});
+    parser.process(app);
+
+    QDir root(parser.positionalArguments().value(0, "."));
+    BenchSettings settings;
+    settings.threads = std::max(1u, parser.value(threadsOpt).toUInt());
+    settings.min_time_s = parser.value(minTimeOpt).toDouble();
+    double tolerance = parser.value(toleranceOpt).toDouble();
+
+    QJsonObject baseline;
+    if (parser.isSet(baselineOpt)) {
+        QFile file(parser.value(baselineOpt));
+        if (!file.open(QIODevice::ReadOnly)) {
+            std::fprintf(stderr, "cannot read baseline %s\n", qPrintable(file.fileName()));
+            return 2;
+        }
+        baseline = QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    std::vector<Workload> works = loadWorkloads(root);
+    if (works.size() == 1)
+        std::fprintf(stderr, "warning: no images or drawings under %s; is it the repository root?\n",
+                     qPrintable(root.absolutePath()));
+
+    std::vector<OpResult> results;
+    QJsonArray results_json;
+    std::printf("%-32s %5s %10s %10s %9s %9s %12s %10s\n", "workload/operation", "runs", "median ms", "min ms",
+                "v in", "v out", "v/s", "heap kB");
+    for (const Workload& work : works) {
+        for (const OpResult& r : runWorkload(work, settings, parser.value(onlyOpt).toStdString())) {
+            std::printf("%-32s %5d %10.2f %10.2f %9zu %9zu %12.0f %10zu\n",
+                        (r.workload + "/" + r.operation).c_str(), r.runs, r.median_ms, r.min_ms, r.vertices_in,
+                        r.vertices_out, r.vertices_per_s, r.peak_heap_bytes / 1024);
+            std::fflush(stdout);
+            results.push_back(r);
+            results_json.append(toJson(r));
+        }
+    }
+
+    QJsonObject doc;
+    doc["clipper2"] = QString::fromLatin1(CLIPPER2_VERSION);
+    doc["threads"] = int(settings.threads);
+    doc["units_per_mm"] = units_per_mm;
+    doc["max_rss_kb"] = double(maxRssKb());
+    doc["results"] = results_json;
+    QFile out(parser.value(outputOpt));
+    if (!out.open(QIODevice::WriteOnly)) {
+        std::fprintf(stderr, "cannot write %s\n", qPrintable(out.fileName()));
+        return 2;
+    }
+    out.write(QJsonDocument(doc).toJson());
+    std::printf("max RSS %ld kB, results in %s\n", maxRssKb(), qPrintable(out.fileName()));
+
+    if (!baseline.isEmpty()) {
+        int regressions = compareBaseline(results, baseline, settings.threads, tolerance);
+        if (regressions) {
+            std::printf("%d regression%s beyond %.0f%%\n", regressions, regressions == 1 ? "" : "s",
+                        tolerance * 100.0);
+            return 1;
+        }
+    }
+    return 0;
+}
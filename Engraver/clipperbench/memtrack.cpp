@@ -0,0 +1,63 @@
+// memtrack.cpp
+// Each block carries its size in a header ahead of the pointer handed out,
+// so delete knows what to take off the count without asking the allocator.
+// malloc'd memory (nanosvg, Qt's C parts) is not seen; Clipper allocates
+// only through new.
+
+#include "memtrack.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Keeps the block behind the header aligned for any type new may hold.
+const size_t header_size = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t);
+
+std::atomic<size_t> in_use{0};
+std::atomic<size_t> peak{0};
+
+void* allocate(size_t size) {
+    void* block = std::malloc(size + header_size);
+    if (!block) return nullptr;
+    *static_cast<size_t*>(block) = size;
+    size_t now = in_use.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t high = peak.load(std::memory_order_relaxed);
+    while (now > high && !peak.compare_exchange_weak(high, now, std::memory_order_relaxed)) {}
+    return static_cast<char*>(block) + header_size;
+}
+
+void release(void* p) {
+    if (!p) return;
+    void* block = static_cast<char*>(p) - header_size;
+    in_use.fetch_sub(*static_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+} // namespace
+
+size_t heapInUse() { return in_use.load(std::memory_order_relaxed); }
+size_t heapPeak() { return peak.load(std::memory_order_relaxed); }
+void resetHeapPeak() { peak.store(in_use.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+
+void* operator new(size_t size) {
+    void* p = allocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    void* p = allocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
@@ -0,0 +1,19 @@
+// memtrack.h
+// Heap high-water mark of the running process, counted by the global
+// operator new and delete that memtrack.cpp replaces
+
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+
+#include <cstddef>
+
+// Bytes allocated through operator new and not yet freed.
+size_t heapInUse();
+
+// The most heapInUse() has been since the last resetHeapPeak().
+size_t heapPeak();
+
+// Starts a new high-water mark at what is in use now.
+void resetHeapPeak();
+
+#endif // MEMTRACK_H
@@ -0,0 +1,470 @@
+// adaptive.cpp
+// The cleared tool-centre area F starts as a small disc at the deepest point
+// of each component and grows by Inflate(F, step) clipped to the domain. The
+// boundary of each new F is the next pass. Engagement is estimated on a stock
+// raster: at every sample the forward half of the tool circle is probed, and
+// the covered angle phi gives a radial width of r * (1 - cos phi). Where a
+// sample exceeds the limit the front is pulled back locally to a smaller
+// step, so straight runs keep the full step and only corners slow down. Spans
+// that touch no stock (walls already cut, earlier tools' area) are dropped
+// and bridged by links.
+
+#include "adaptive.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const int kProbes = 48;            // probes on the forward half circle
+const double kOverload = 1.2;      // probe quantisation allowance before a sample counts as over
+const int kMaxGridCells = 4096 * 4096;
+const double kStartStep = 0.75;    // first try for a front, as a fraction of the limit
+const int kMaxAttempts = 6;        // pull-back rounds per front
+const double kStepRatio = 1.25;    // spacing of the quantised slowed steps
+const double kFrontTolerance = 0.001; // mm, deviation allowed when thinning a grown front
+const double kSimplify = 0.005;    // mm, deviation allowed when sampling fronts and cuts
+const double kLinkAllowance = 0.01; // mm a stay-down link may stray outside the domain
+const double kMinGrowth = 1e-6;    // mm^2 a front must add to count as progress
+
+enum Cell : uint8_t { Outside = 0, Clear = 1, Stock = 2 };
+
+class StockGrid {
+public:
+    StockGrid(const Rect64& bounds, double cell)
+        : cell_(cell), x0_(static_cast<double>(bounds.left)), y0_(static_cast<double>(bounds.top)) {
+        w_ = std::max(1, static_cast<int>(std::ceil(bounds.Width() / cell)) + 1);
+        h_ = std::max(1, static_cast<int>(std::ceil(bounds.Height() / cell)) + 1);
+        cells_.assign(static_cast<size_t>(w_) * h_, Outside);
+    }
+
+    // Scanline fill with non-zero winding; only cells already >= min are set.
+    void fill(const Paths64& paths, Cell value, Cell min) {
+        std::vector<std::pair<double, int>> xs;
+        for (int row = 0; row < h_; ++row) {
+            double y = y0_ + (row + 0.5) * cell_;
+            xs.clear();
+            for (const auto& path : paths) {
+                for (size_t i = 0, n = path.size(); i < n; ++i) {
+                    const Point64& a = path[i];
+                    const Point64& b = path[(i + 1) % n];
+                    if ((a.y <= y) == (b.y <= y)) continue;
+                    double x = a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y);
+                    xs.emplace_back(x, b.y > a.y ? 1 : -1);
+                }
+            }
+            std::sort(xs.begin(), xs.end());
+            int winding = 0;
+            for (size_t i = 0; i + 1 < xs.size(); ++i) {
+                winding += xs[i].second;
+                if (winding == 0) continue;
+                int c0 = std::max(0, static_cast<int>(std::ceil((xs[i].first - x0_) / cell_ - 0.5)));
+                int c1 = std::min(w_ - 1, static_cast<int>(std::floor((xs[i + 1].first - x0_) / cell_ - 0.5)));
+                for (int c = c0; c <= c1; ++c) {
+                    uint8_t& v = cells_[static_cast<size_t>(row) * w_ + c];
+                    if (v < min) continue;
+                    stock_ += (value == Stock) - (v == Stock);
+                    v = value;
+                }
+            }
+        }
+    }
+
+    Cell at(double x, double y) const {
+        int c = static_cast<int>(std::floor((x - x0_) / cell_));
+        int r = static_cast<int>(std::floor((y - y0_) / cell_));
+        if (c < 0 || r < 0 || c >= w_ || r >= h_) return Outside;
+        return static_cast<Cell>(cells_[static_cast<size_t>(r) * w_ + c]);
+    }
+
+    // Clears the stock under a tool at p. The disc is grown by most of a cell
+    // so that stock the tool really removed never survives as raster residue
+    // along walls, where it would read as engagement on every later front.
+    void stampDisc(const PointD& p, double tool_radius) {
+        double radius = tool_radius + 0.75 * cell_;
+        int c0 = std::max(0, static_cast<int>(std::floor((p.x - radius - x0_) / cell_)));
+        int c1 = std::min(w_ - 1, static_cast<int>(std::floor((p.x + radius - x0_) / cell_)));
+        int r0 = std::max(0, static_cast<int>(std::floor((p.y - radius - y0_) / cell_)));
+        int r1 = std::min(h_ - 1, static_cast<int>(std::floor((p.y + radius - y0_) / cell_)));
+        double rr = radius * radius;
+        for (int r = r0; r <= r1; ++r) {
+            double dy = y0_ + (r + 0.5) * cell_ - p.y;
+            for (int c = c0; c <= c1; ++c) {
+                double dx = x0_ + (c + 0.5) * cell_ - p.x;
+                uint8_t& v = cells_[static_cast<size_t>(r) * w_ + c];
+                if (v == Stock && dx * dx + dy * dy <= rr) {
+                    v = Clear;
+                    --stock_;
+                }
+            }
+        }
+    }
+
+    bool anyStock() const { return stock_ > 0; }
+
+private:
+    double cell_, x0_, y0_;
+    int w_ = 0, h_ = 0;
+    std::vector<uint8_t> cells_;
+    ptrdiff_t stock_ = 0;   // cells that are Stock, kept as they change
+};
+
+double distance(const Point64& a, const Point64& b) {
+    return std::hypot(static_cast<double>(a.x - b.x), static_cast<double>(a.y - b.y));
+}
+
+// Splits a closed ring into points no further apart than spacing; the result
+// is closed by repeating the first point.
+Path64 densify(const Path64& ring, double spacing) {
+    Path64 out;
+    for (size_t i = 0; i < ring.size(); ++i) {
+        const Point64& a = ring[i];
+        const Point64& b = ring[(i + 1) % ring.size()];
+        int n = std::max(1, static_cast<int>(std::ceil(distance(a, b) / spacing)));
+        for (int k = 0; k < n; ++k) {
+            double t = static_cast<double>(k) / n;
+            out.emplace_back(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+        }
+    }
+    if (!out.empty()) out.push_back(out.front());
+    return out;
+}
+
+// Unions neighbours in the list pairwise, then the results pairwise, and so
+// on. Consecutive cuts overlap most, so each round drops most of the edges
+// before the next; one union over every sweep resolves all the overlaps at
+// once and takes many times longer.
+Paths64 unionInPairs(std::vector<Paths64> parts) {
+    if (parts.empty()) return Paths64();
+    while (parts.size() > 1) {
+        size_t kept = 0;
+        for (size_t i = 0; i < parts.size(); i += 2) {
+            if (i + 1 < parts.size()) {
+                parts[i].insert(parts[i].end(), parts[i + 1].begin(), parts[i + 1].end());
+                parts[kept++] = Union(parts[i], FillRule::NonZero);
+            } else {
+                parts[kept++] = std::move(parts[i]);
+            }
+        }
+        parts.resize(kept);
+    }
+    return std::move(parts.front());
+}
+
+class AdaptiveBuilder {
+public:
+    AdaptiveBuilder(const AdaptiveSettings& settings, StockGrid& grid)
+        : radius(settings.tool_radius * units_per_mm),
+          limit(std::min(settings.max_engagement, settings.tool_radius) * units_per_mm),
+          minStep(std::max(1e-3 * units_per_mm, std::min(settings.min_step * units_per_mm, limit))),
+          spacing(radius / 4.0),
+          minEngagement(0.1 * limit),
+          grid(grid) {}
+
+    void clearComponent(const Paths64& comp, AdaptiveResult& result) {
+        domain = &comp;
+        Paths64 cleared = seed(comp, result);
+        double lastArea = std::fabs(Area(cleared));
+
+        while (grid.anyStock()) {
+            // The front advances most of a full step (a front cut right at the
+            // limit leaves scallops that overload the next one), then each round
+            // pulls it back inside discs around the samples that still bite too
+            // deep, to the step that sample would need. The rest keeps its step.
+            Paths64 front = Intersect(grow(cleared, kStartStep * limit), comp, FillRule::NonZero);
+            std::vector<Path64> rings;
+            std::vector<std::vector<double>> engagement;
+            std::vector<std::pair<Point64, double>> slowed;   // disc centre, step inside it
+            for (int attempt = 0; ; ++attempt) {
+                std::vector<Point64> over;
+                std::vector<double> overE;
+                evaluate(front, rings, engagement, over, overE);
+                if (attempt == kMaxAttempts) break;
+
+                std::map<int, std::vector<Point64>> bands;   // quantised step -> disc centres
+                for (size_t i = 0; i < over.size(); ++i) {
+                    double current = kStartStep * limit;
+                    for (const auto& s : slowed) {
+                        if (distance(s.first, over[i]) < radius) current = std::min(current, s.second);
+                    }
+                    if (current <= minStep) continue;
+                    double want = std::max(minStep, current * std::max(0.25, limit / overE[i]) * 0.9);
+                    int band = static_cast<int>(std::floor(std::log(want / minStep) / std::log(kStepRatio)));
+                    bands[band].push_back(over[i]);
+                }
+                if (bands.empty()) break;
+
+                // Larger steps first so that overlapping smaller ones win.
+                for (auto it = bands.rbegin(); it != bands.rend(); ++it) {
+                    double step = minStep * std::pow(kStepRatio, it->first);
+                    Paths64 hot = discs(it->second, radius);
+                    front = Union(Difference(front, hot, FillRule::NonZero),
+                                  Intersect(Intersect(grow(cleared, step), hot, FillRule::NonZero), comp,
+                                            FillRule::NonZero),
+                                  FillRule::NonZero);
+                    for (const auto& p : it->second) slowed.emplace_back(p, step);
+                }
+            }
+
+            // Once the front stops growing it is the wall, which is already cut;
+            // whatever stock is left there is out of the tool's reach.
+            double area = std::fabs(Area(front));
+            if (area <= lastArea + kMinGrowth * units_per_mm * units_per_mm) break;
+            cutRings(rings, engagement, result);
+            cleared = front;
+            lastArea = area;
+        }
+    }
+
+private:
+    double radius, limit, minStep, spacing;   // units
+    double minEngagement;
+    StockGrid& grid;
+    const Paths64* domain = nullptr;
+    Point64 last;
+    bool haveLast = false;
+
+    // Plunges at the deepest point of the component (approximated by the last
+    // non-empty inset) and cuts a small circle there.
+    Paths64 seed(const Paths64& comp, AdaptiveResult& result) {
+        Rect64 b = GetBounds(comp);
+        double lo = 0, hi = std::min(b.Width(), b.Height()) / 2.0;
+        Paths64 inset = comp;
+        for (int i = 0; i < 12; ++i) {
+            double mid = (lo + hi) / 2.0;
+            Paths64 trial = InflatePaths(comp, -mid, JoinType::Round, EndType::Polygon);
+            if (trial.empty()) hi = mid;
+            else { lo = mid; inset = std::move(trial); }
+        }
+        Point64 centre = inset.front().front();
+        double ring = std::min(lo, limit);
+        if (ring < minStep) ring = minStep;
+
+        Path64 circle = Ellipse(centre, ring, ring, 32);
+        CutPath cut;
+        cut.points = circle;
+        cut.points.push_back(circle.front());
+        cut.retract = true;
+        emit(cut, result);
+        return Intersect(Paths64{ circle }, comp, FillRule::NonZero);
+    }
+
+    double probe(const PointD& p, const PointD& dir) const {
+        int hits = 0;
+        double r = radius * 0.98;
+        double base = std::atan2(dir.y, dir.x);
+        for (int k = 0; k < kProbes; ++k) {
+            double a = base - kPi / 2.0 + kPi * (k + 0.5) / kProbes;
+            if (grid.at(p.x + r * std::cos(a), p.y + r * std::sin(a)) == Stock) ++hits;
+        }
+        double phi = kPi * hits / kProbes;
+        return radius * (1.0 - std::cos(phi));
+    }
+
+    // Thinned to a micron: each round offset turns every vertex into an arc,
+    // so without it a front has twice the vertices of the one before.
+    static Paths64 grow(const Paths64& paths, double delta) {
+        return SimplifyPaths(InflatePaths(paths, delta, JoinType::Round, EndType::Polygon),
+                             kFrontTolerance * units_per_mm);
+    }
+
+    // Discs around the given points, skipping points already well inside one.
+    static Paths64 discs(const std::vector<Point64>& points, double r) {
+        Paths64 out;
+        std::vector<Point64> centres;
+        for (const auto& p : points) {
+            bool covered = false;
+            for (const auto& c : centres) {
+                if (distance(c, p) < r / 2) { covered = true; break; }
+            }
+            if (covered) continue;
+            centres.push_back(p);
+            out.push_back(Ellipse(p, r, r, 24));
+        }
+        return out;
+    }
+
+    void evaluate(const Paths64& front, std::vector<Path64>& rings, std::vector<std::vector<double>>& engagement,
+                  std::vector<Point64>& over, std::vector<double>& overE) {
+        rings.clear();
+        engagement.clear();
+        for (const auto& path : SimplifyPaths(front, kSimplify * units_per_mm)) {
+            Path64 ring = densify(path, spacing);
+            if (ring.size() < 3) continue;
+            std::vector<double> e(ring.size(), 0.0);
+            size_t n = ring.size() - 1;
+            for (size_t i = 0; i < n; ++i) {
+                // Heading over a chord of at least half a sample spacing; the
+                // offset output has clusters of nearly coincident points.
+                size_t j = i + 1;
+                while (j < i + n && distance(ring[j % n], ring[i]) < spacing / 2) ++j;
+                PointD dir(ring[j % n].x - ring[i].x, ring[j % n].y - ring[i].y);
+                e[i] = probe(PointD(ring[i]), dir);
+                if (e[i] < minEngagement) e[i] = 0;   // raster noise along cut walls
+                if (e[i] > limit * kOverload) { over.push_back(ring[i]); overE.push_back(e[i]); }
+            }
+            e.back() = e.front();
+            rings.push_back(std::move(ring));
+            engagement.push_back(std::move(e));
+        }
+    }
+
+    // A straight move is taken at depth when its centre line stays in the
+    // domain (no gouge) and it never bites deeper than the engagement limit.
+    bool linkIsCleared(const Point64& a, const Point64& b) const {
+        if (a == b) return true;
+        double len = distance(a, b);
+        PointD dir(b.x - a.x, b.y - a.y);
+        // The last stretch is the step onto the new front, which every pass
+        // makes; probing it head-on would read as a full slot.
+        double probed = len - limit;
+        int n = std::max(1, static_cast<int>(std::ceil(probed / spacing)));
+        for (int i = 0; i <= n && probed > 0; ++i) {
+            double t = probed * i / n / len;
+            if (probe(PointD(a.x + t * dir.x, a.y + t * dir.y), dir) > limit * kOverload) return false;
+        }
+        Clipper64 clipper;
+        clipper.AddOpenSubject(Paths64{ Path64{ a, b } });
+        clipper.AddClip(*domain);
+        Paths64 closed, open;
+        clipper.Execute(ClipType::Difference, FillRule::NonZero, closed, open);
+        for (const auto& part : open) {
+            if (part.size() >= 2 && Length(part) > kLinkAllowance * units_per_mm) return false;
+        }
+        return true;
+    }
+
+    void emit(CutPath& cut, AdaptiveResult& result) {
+        if (cut.points.size() < 2) return;
+        if (haveLast && !cut.retract) {
+            double len = distance(last, cut.points.front());
+            int n = static_cast<int>(std::ceil(len / spacing));
+            for (int i = 1; i < n; ++i) {
+                double t = static_cast<double>(i) / n;
+                grid.stampDisc(PointD(last.x + t * (cut.points.front().x - last.x), last.y + t * (cut.points.front().y - last.y)), radius);
+            }
+            result.path_length += len;
+        }
+        for (const auto& p : cut.points) grid.stampDisc(PointD(p), radius);
+        cut.points = SimplifyPath(cut.points, kSimplify * units_per_mm, false);
+        result.path_length += Length(cut.points);
+        last = cut.points.back();
+        haveLast = true;
+        result.cuts.push_back(std::move(cut));
+    }
+
+    void cutRings(std::vector<Path64>& rings, std::vector<std::vector<double>>& engagement, AdaptiveResult& result) {
+        std::vector<size_t> order(rings.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+
+        while (!order.empty()) {
+            // Nearest ring first, entered at its closest engaged sample.
+            size_t pickIdx = 0, pickStart = 0;
+            double best = std::numeric_limits<double>::max();
+            for (size_t o = 0; o < order.size(); ++o) {
+                const Path64& ring = rings[order[o]];
+                for (size_t i = 0; i + 1 < ring.size(); ++i) {
+                    if (engagement[order[o]][i] <= 0) continue;
+                    double d = haveLast ? distance(ring[i], last) : 0.0;
+                    if (d < best) { best = d; pickIdx = o; pickStart = i; }
+                }
+            }
+            if (best == std::numeric_limits<double>::max()) break;   // nothing engages
+            size_t idx = order[pickIdx];
+            order.erase(order.begin() + pickIdx);
+            cutRing(rings[idx], engagement[idx], pickStart, result);
+        }
+    }
+
+    // Walks the closed ring once from start, cutting the spans that touch stock.
+    // Air gaps shorter than a tool diameter are fed through; longer ones become
+    // a stay-down link when the straight move is clear, otherwise a retract.
+    void cutRing(const Path64& ring, const std::vector<double>& e, size_t start, AdaptiveResult& result) {
+        size_t n = ring.size() - 1;
+        CutPath cut;
+        Path64 gap;
+        double gapLength = 0;
+        bool first = true;
+
+        auto flushCut = [&]() {
+            if (cut.points.size() >= 2) emit(cut, result);
+            cut = CutPath();
+        };
+
+        for (size_t k = 0; k <= n; ++k) {
+            size_t i = (start + k) % n;
+            const Point64& p = ring[i];
+            bool engaged = e[i] > 0 || e[(i + n - 1) % n] > 0;
+            if (engaged) {
+                result.max_engagement = std::max(result.max_engagement, e[i]);
+                if (e[i] > 0) { engagedSum += e[i]; ++engagedCount; }
+                if (first) {
+                    cut.retract = !haveLast || !linkIsCleared(last, p);
+                    first = false;
+                } else if (!gap.empty()) {
+                    if (gapLength < 2.0 * radius) {
+                        cut.points.insert(cut.points.end(), gap.begin(), gap.end());
+                    } else {
+                        flushCut();
+                        cut.retract = !linkIsCleared(last, p);
+                    }
+                }
+                gap.clear();
+                gapLength = 0;
+                cut.points.push_back(p);
+            } else if (!first) {
+                gapLength += distance(gap.empty() ? cut.points.back() : gap.back(), p);
+                gap.push_back(p);
+            }
+        }
+        flushCut();
+        result.mean_engagement = engagedCount ? engagedSum / engagedCount : 0.0;
+    }
+
+    double engagedSum = 0;
+    size_t engagedCount = 0;
+};
+
+} // namespace
+
+AdaptiveResult adaptiveClear(const Paths64& domain, const Paths64& region, const Paths64& stock,
+                             const AdaptiveSettings& settings, Paths64* swept) {
+    AdaptiveResult result;
+    if (swept) swept->clear();
+    if (domain.empty() || settings.tool_radius <= 0 || settings.max_engagement <= 0) return result;
+
+    // Stock the tool cannot reach (sharp inside corners, pixel steps) would
+    // count as engagement on every pass along the wall, so it is left out.
+    double radius = settings.tool_radius * units_per_mm;
+    Paths64 reach = Intersect(region, InflatePaths(domain, radius, JoinType::Round, EndType::Polygon), FillRule::NonZero);
+    Rect64 bounds = GetBounds(reach);
+    double cell = std::min(settings.tool_radius, settings.max_engagement) * units_per_mm / 6.0;
+    while ((bounds.Width() / cell + 2) * (bounds.Height() / cell + 2) > kMaxGridCells) cell *= 1.5;
+    StockGrid grid(bounds, cell);
+    grid.fill(reach, Clear, Outside);
+    grid.fill(stock, Stock, Clear);
+
+    AdaptiveBuilder builder(settings, grid);
+    for (const Paths64& comp : splitComponents(domain)) builder.clearComponent(comp, result);
+
+    // Only what the cuts and their stay-down links passed over is removed;
+    // stock the fronts never reached stays for the next tool.
+    if (swept) {
+        std::vector<Paths64> sweeps;
+        for (size_t i = 0; i < result.cuts.size(); ++i) {
+            Path64 path = result.cuts[i].points;
+            if (i > 0 && !result.cuts[i].retract) path.insert(path.begin(), result.cuts[i - 1].points.back());
+            sweeps.push_back(InflatePaths(Paths64{ path }, radius, JoinType::Round, EndType::Round));
+        }
+        *swept = unionInPairs(std::move(sweeps));
+    }
+    // The builder measures in units.
+    result.max_engagement = toMm(result.max_engagement);
+    result.mean_engagement = toMm(result.mean_engagement);
+    result.path_length = toMm(result.path_length);
+    return result;
+}
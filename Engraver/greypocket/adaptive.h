@@ -0,0 +1,32 @@
+// adaptive.h
+// Adaptive (engagement-limited) clearing: fronts grow outward from a seed and
+// the step between fronts shrinks wherever the tool would bite too deep
+
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include <vector>
+#include "clipper2/clipper.h"
+#include "pocketing.h"
+
+struct AdaptiveSettings {
+    double tool_radius = 1.0;
+    double max_engagement = 0.4;   // radial width of cut in mm, at most the tool radius
+    double min_step = 0.05;        // smallest front step before giving up on the limit
+};
+
+struct AdaptiveResult {
+    std::vector<CutPath> cuts;
+    double max_engagement = 0;    // estimated over every cutting sample, mm
+    double mean_engagement = 0;   // average over samples that touch stock, mm
+    double path_length = 0;       // feed length including stay-down links, mm
+};
+
+// domain: tool-centre area. region: the pocket at this level. stock: the part
+// of region still standing (region itself unless an earlier tool cut here).
+// swept, when given, is the area the cuts and links passed the tool over.
+AdaptiveResult adaptiveClear(const Clipper2Lib::Paths64& domain, const Clipper2Lib::Paths64& region,
+                             const Clipper2Lib::Paths64& stock, const AdaptiveSettings& settings,
+                             Clipper2Lib::Paths64* swept = nullptr);
+
+#endif // ADAPTIVE_H
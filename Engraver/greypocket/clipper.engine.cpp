@@ -275,49 +275,6 @@ namespace Clipper2Lib {
     return cnt;
   }
 
-  inline OutPt* DuplicateOp(OutPt* op, bool insert_after)
-  {
-    OutPt* result = new OutPt(op->pt, op->outrec);
-    if (insert_after)
-    {
-      result->next = op->next;
-      result->next->prev = result;
-      result->prev = op;
-      op->next = result;
-    }
-    else
-    {
-      result->prev = op->prev;
-      result->prev->next = result;
-      result->next = op;
-      op->prev = result;
-    }
-    return result;
-  }
-
-  inline OutPt* DisposeOutPt(OutPt* op)
-  {
-    OutPt* result = op->next;
-    op->prev->next = op->next;
-    op->next->prev = op->prev;
-    delete op;
-    return result;
-  }
-
-
-  inline void DisposeOutPts(OutRec* outrec)
-  {
-    OutPt* op = outrec->pts;
-    op->prev->next = nullptr;
-    while (op)
-    {
-      OutPt* tmp = op;
-      op = op->next;
-      delete tmp;
-    };
-    outrec->pts = nullptr;
-  }
-
 
   bool IntersectListSort(const IntersectNode& a, const IntersectNode& b)
   {
@@ -609,7 +566,7 @@ namespace Clipper2Lib {
   }
 
   void AddPaths_(const Paths64& paths, PathType polytype, bool is_open,
-    std::vector<Vertex*>& vertexLists, LocalMinimaList& locMinList)
+    ObjectPool<Vertex>& vertexPool, LocalMinimaList& locMinList)
   {
     const auto total_vertex_count =
       std::accumulate(paths.begin(), paths.end(), size_t(0),
@@ -617,7 +574,7 @@ namespace Clipper2Lib {
         {return a + path.size(); });
     if (total_vertex_count == 0) return;
 
-    Vertex* vertices = new Vertex[total_vertex_count], * v = vertices;
+    Vertex* v = vertexPool.NewArray(total_vertex_count);
     for (const Path64& path : paths)
     {
       //for each path create a circular double linked list of vertices
@@ -708,8 +665,6 @@ namespace Clipper2Lib {
         else prev_v->flags = prev_v->flags | VertexFlags::LocalMax;
       }
     } // end processing current path
-
-    vertexLists.emplace_back(vertices);
   }
 
   //------------------------------------------------------------------------------
@@ -728,7 +683,7 @@ namespace Clipper2Lib {
   void ReuseableDataContainer64::AddPaths(const Paths64& paths,
     PathType polytype, bool is_open)
   {
-    AddPaths_(paths, polytype, is_open, vertex_lists_, minima_list_);
+    AddPaths_(paths, polytype, is_open, vertex_pool_, minima_list_);
   }
 
   ReuseableDataContainer64::~ReuseableDataContainer64()
@@ -739,8 +694,7 @@ namespace Clipper2Lib {
   void ReuseableDataContainer64::Clear()
   {
     minima_list_.clear();
-    for (auto v : vertex_lists_) delete[] v;
-    vertex_lists_.clear();
+    vertex_pool_.Reset();
   }
 
   //------------------------------------------------------------------------------
@@ -754,12 +708,9 @@ namespace Clipper2Lib {
 
   void ClipperBase::DeleteEdges(Active*& e)
   {
-    while (e)
-    {
-      Active* e2 = e;
-      e = e->next_in_ael;
-      delete e2;
-    }
+    // Actives need no destructor, so they all go back in one Reset
+    e = nullptr;
+    active_pool_.Reset();
   }
 
   void ClipperBase::CleanUp()
@@ -837,7 +788,7 @@ namespace Clipper2Lib {
   {
     if (is_open) has_open_paths_ = true;
     minima_list_sorted_ = false;
-    AddPaths_(paths, polytype, is_open, vertex_lists_, minima_list_);
+    AddPaths_(paths, polytype, is_open, vertex_pool_, minima_list_);
   }
 
   void ClipperBase::AddReuseableData(const ReuseableDataContainer64& reuseable_data)
@@ -878,21 +829,66 @@ namespace Clipper2Lib {
     return true;
   }
 
+  inline OutPt* ClipperBase::DuplicateOp(OutPt* op, bool insert_after)
+  {
+    OutPt* result = outpt_pool_.New(op->pt, op->outrec);
+    if (insert_after)
+    {
+      result->next = op->next;
+      result->next->prev = result;
+      result->prev = op;
+      op->next = result;
+    }
+    else
+    {
+      result->prev = op->prev;
+      result->prev->next = result;
+      result->next = op;
+      op->prev = result;
+    }
+    return result;
+  }
+
+  inline OutPt* ClipperBase::DisposeOutPt(OutPt* op)
+  {
+    OutPt* result = op->next;
+    op->prev->next = op->next;
+    op->next->prev = op->prev;
+    outpt_pool_.Delete(op);
+    return result;
+  }
+
+  inline void ClipperBase::DisposeOutPts(OutRec* outrec)
+  {
+    OutPt* op = outrec->pts;
+    op->prev->next = nullptr;
+    while (op)
+    {
+      OutPt* tmp = op;
+      op = op->next;
+      outpt_pool_.Delete(tmp);
+    };
+    outrec->pts = nullptr;
+  }
+
   void ClipperBase::DisposeAllOutRecs()
   {
+    // OutPts need no destructor, so they all go back in one Reset
     for (auto outrec : outrec_list_)
     {
-      if (outrec->pts) DisposeOutPts(outrec);
-      delete outrec;
+      if (outrec->splits) splits_pool_.Delete(outrec->splits);
+      outrec_pool_.Delete(outrec);
     }
     outrec_list_.resize(0);
+    outpt_pool_.Reset();
+    outrec_pool_.Reset();
+    splits_pool_.Reset();
   }
 
   void ClipperBase::DisposeVerticesAndLocalMinima()
   {
     minima_list_.clear();
-    for (auto v : vertex_lists_) delete[] v;
-    vertex_lists_.clear();
+    vertex_pool_.Reset();
   }
 
 
@@ -1210,7 +1206,7 @@ namespace Clipper2Lib {
       }
       else
       {
-        left_bound = new Active();
+        left_bound = active_pool_.New();
         left_bound->bot = local_minima->vertex->pt;
         left_bound->curr_x = left_bound->bot.x;
         left_bound->wind_dx = -1;
@@ -1226,7 +1222,7 @@ namespace Clipper2Lib {
       }
       else
       {
-        right_bound = new Active();
+        right_bound = active_pool_.New();
         right_bound->bot = local_minima->vertex->pt;
         right_bound->curr_x = right_bound->bot.x;
         right_bound->wind_dx = 1;
@@ -1371,7 +1367,7 @@ namespace Clipper2Lib {
       }
     }
 
-    OutPt* op = new OutPt(pt, outrec);
+    OutPt* op = outpt_pool_.New(pt, outrec);
     outrec->pts = op;
     return op;
   }
@@ -1482,7 +1478,7 @@ namespace Clipper2Lib {
 
   OutRec* ClipperBase::NewOutRec()
   {
-    OutRec* result = new OutRec();
+    OutRec* result = outrec_pool_.New();
     result->idx = outrec_list_.size();
     outrec_list_.emplace_back(result);
     result->pts = nullptr;
@@ -1513,7 +1509,7 @@ namespace Clipper2Lib {
     else if (pt == op_back->pt)
       return op_back;
 
-    new_op = new OutPt(pt, outrec);
+    new_op = outpt_pool_.New(pt, outrec);
     op_back->prev = new_op;
     new_op->prev = op_front;
     new_op->next = op_back;
@@ -1595,7 +1591,7 @@ namespace Clipper2Lib {
     }
     else
     {
-      OutPt* newOp2 = new OutPt(ip, prevOp->outrec);
+      OutPt* newOp2 = outpt_pool_.New(ip, prevOp->outrec);
       newOp2->prev = prevOp;
       newOp2->next = nextNextOp;
       nextNextOp->prev = newOp2;
@@ -1615,7 +1611,7 @@ namespace Clipper2Lib {
 
       splitOp->outrec = newOr;
       splitOp->next->outrec = newOr;
-      OutPt* newOp = new OutPt(ip, newOr);
+      OutPt* newOp = outpt_pool_.New(ip, newOr);
       newOp->prev = splitOp->next;
       newOp->next = splitOp;
       newOr->pts = newOp;
@@ -1626,20 +1622,20 @@ namespace Clipper2Lib {
       {
         if (Path2ContainsPath1(prevOp, newOp))
         {
-          newOr->splits = new OutRecList();
+          newOr->splits = splits_pool_.New();
           newOr->splits->emplace_back(outrec);
         }
         else
         {
-          if (!outrec->splits) outrec->splits = new OutRecList();
+          if (!outrec->splits) outrec->splits = splits_pool_.New();
           outrec->splits->emplace_back(newOr);
         }
       }
     }
     else
     {
-      delete splitOp->next;
-      delete splitOp;
+      outpt_pool_.Delete(splitOp->next);
+      outpt_pool_.Delete(splitOp);
     }
   }
 
@@ -1711,7 +1707,7 @@ namespace Clipper2Lib {
 
     e.outrec = outrec;
 
-    OutPt* op = new OutPt(pt, outrec);
+    OutPt* op = outpt_pool_.New(pt, outrec);
     outrec->pts = op;
     return op;
   }
@@ -2106,7 +2102,7 @@ namespace Clipper2Lib {
     else
       actives_ = next;
     if (next) next->prev_in_ael = prev;
-    delete& e;
+    active_pool_.Delete(&e);
   }
 
 
@@ -2266,9 +2262,9 @@ namespace Clipper2Lib {
     }
   }
 
-  void MoveSplits(OutRec* fromOr, OutRec* toOr)
+  void ClipperBase::MoveSplits(OutRec* fromOr, OutRec* toOr)
   {
-    if (!toOr->splits) toOr->splits = new OutRecList();
+    if (!toOr->splits) toOr->splits = splits_pool_.New();
     OutRecList::iterator orIter = fromOr->splits->begin();
     for (; orIter != fromOr->splits->end(); ++orIter)
       if (toOr != *orIter) // #987
@@ -2323,7 +2319,7 @@ namespace Clipper2Lib {
           else
             or2->owner = or1->owner;
 
-          if (!or1->splits) or1->splits = new OutRecList();
+          if (!or1->splits) or1->splits = splits_pool_.New();
           or1->splits->emplace_back(or2);
         }
         else
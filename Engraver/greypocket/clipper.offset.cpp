@@ -9,11 +9,16 @@
 
 #include "clipper2/clipper.h"
 #include "clipper2/clipper.offset.h"
+#include "clipper2/clipper.parallel.h"
 
 namespace Clipper2Lib {
 
 const double floating_point_tolerance = 1e-12;
 
+// Parallel execution hands out work in slices of at least this many paths,
+// since below that a thread costs more than it saves.
+const size_t parallel_min_paths = 64;
+
 // Clipper2 approximates arcs by using series of relatively short straight
 //line segments. And logically, shorter line segments will produce better arc
 // approximations. But very short segments can degrade performance, usually
@@ -453,6 +458,11 @@ void ClipperOffset::OffsetOpenPath(Group& group, const Path64& path)
 }
 
 void ClipperOffset::DoGroupOffset(Group& group)
+{
+	DoGroupOffset(group, 0, group.paths_in.size());
+}
+
+void ClipperOffset::DoGroupOffset(Group& group, size_t begin, size_t end)
 {
 	if (group.end_type == EndType::Polygon)
 	{
@@ -486,8 +496,8 @@ void ClipperOffset::DoGroupOffset(Group& group)
 	}
 
 	//double min_area = PI * Sqr(group_delta_);
-	Paths64::const_iterator path_in_it = group.paths_in.cbegin();
-	for ( ; path_in_it != group.paths_in.cend(); ++path_in_it)
+	Paths64::const_iterator path_in_it = group.paths_in.cbegin() + begin;
+	for ( ; path_in_it != group.paths_in.cbegin() + end; ++path_in_it)
 	{
 		Path64::size_type pathLen = path_in_it->size();
 		path_out.clear();
@@ -571,10 +581,92 @@ bool ClipperOffset::CheckReverseOrientation()
 	return is_reversed_orientation;
 }
 
+bool ClipperOffset::OffsetGroupsParallel(unsigned threads)
+{
+	if (deltaCallback64_) return false;
+
+	struct Slice { size_t group, begin, end; double delta; };
+	size_t total = 0;
+	for (const Group& g : groups_) total += g.paths_in.size();
+	// a few slices per thread, so one slow slice doesn't hold up the rest
+	size_t slice_size = std::max(parallel_min_paths, (total + 4 * threads - 1) / (4 * threads));
+	std::vector<Slice> slices;
+	double delta = delta_;
+	for (size_t i = 0; i < groups_.size(); ++i)
+	{
+		const Group& g = groups_[i];
+		// DoGroupOffset makes delta_ positive for this and every later group
+		// once it meets a polygon group without a closed path
+		if (g.end_type == EndType::Polygon && !g.lowest_path_idx.has_value())
+			delta = std::abs(delta);
+		for (size_t b = 0; b < g.paths_in.size(); b += slice_size)
+			slices.push_back({ i, b, std::min(b + slice_size, g.paths_in.size()), delta });
+	}
+	if (slices.size() < 2) return false;
+
+	std::vector<Paths64> parts(slices.size());
+	std::vector<int> errors(slices.size(), 0);
+	details::ParallelFor(slices.size(), threads, [&](size_t i)
+	{
+		const Slice& s = slices[i];
+		ClipperOffset worker(miter_limit_, arc_tolerance_, preserve_collinear_, reverse_solution_);
+		worker.temp_lim_ = temp_lim_;
+		worker.delta_ = s.delta;
+		worker.solution = &parts[i];
+		worker.DoGroupOffset(groups_[s.group], s.begin, s.end);
+		errors[i] = worker.error_code_;
+	});
+	delta_ = delta;
+	// a serial run drops what it has so far when a group fails, so only
+	// the groups after the last failed one are kept
+	size_t first = 0;
+	for (size_t i = 0; i < slices.size(); ++i)
+	{
+		if (!errors[i]) continue;
+		error_code_ |= errors[i];
+		while (first < slices.size() && slices[first].group <= slices[i].group) ++first;
+	}
+	// in slice order, which is the order a serial run adds paths in
+	for (size_t i = first; i < parts.size(); ++i)
+		solution->insert(solution->end(),
+			std::make_move_iterator(parts[i].begin()), std::make_move_iterator(parts[i].end()));
+	return true;
+}
+
+bool ClipperOffset::UnionTiledParallel(unsigned threads, FillRule fill_rule, bool reverse)
+{
+	// the raw paths are unioned tile by tile and the tiles' results merged
+	// pairwise, in blocks of tiles that double in size up to one
+	Paths64 merged;
+	int error_code = 0;
+	if (!details::UnionTiled(fill_rule, *solution, merged, threads, error_code)) return false;
+	solution->clear();
+	error_code_ |= error_code;
+	if (error_code) return true;
+
+	if (solution_tree)
+	{
+		// one more sweep, over clean polygons of one orientation now, nests
+		// them into the tree
+		Clipper64 c;
+		c.PreserveCollinear(preserve_collinear_);
+		c.ReverseSolution(reverse);
+		c.AddSubject(merged);
+		if (!c.Execute(ClipType::Union, FillRule::NonZero, *solution_tree))
+			error_code_ |= undefined_error_i;
+		return true;
+	}
+	if (reverse)
+		for (Path64& path : merged) std::reverse(path.begin(), path.end());
+	solution->swap(merged);
+	return true;
+}
+
 void ClipperOffset::ExecuteInternal(double delta)
 {
 	error_code_ = 0;
 	if (groups_.size() == 0) return;
+	unsigned threads = details::ResolveThreads(threads_);
 	solution->reserve(CalcSolutionCapacity());
 
 	if (std::abs(delta) < 0.5) // ie: offset is insignificant
@@ -593,18 +685,26 @@ void ClipperOffset::ExecuteInternal(double delta)
 			2.0 / (miter_limit_ * miter_limit_);
 
 		delta_ = delta;
-		std::vector<Group>::iterator git;
-		for (git = groups_.begin(); git != groups_.end(); ++git)
+		if (threads < 2 || !OffsetGroupsParallel(threads))
 		{
-			DoGroupOffset(*git);
-			if (!error_code_) continue; // all OK
-			solution->clear();
+			std::vector<Group>::iterator git;
+			for (git = groups_.begin(); git != groups_.end(); ++git)
+			{
+				DoGroupOffset(*git);
+				if (!error_code_) continue; // all OK
+				solution->clear();
+			}
 		}
 	}
 
 	if (!solution->size()) return;
 
 	bool paths_reversed = CheckReverseOrientation();
+#ifndef USINGZ
+	if (threads > 1 && UnionTiledParallel(threads,
+		paths_reversed ? FillRule::Negative : FillRule::Positive,
+		reverse_solution_ != paths_reversed)) return;
+#endif
 	//clean up self-intersections ...
 	Clipper64 c;
 	c.PreserveCollinear(preserve_collinear_);
@@ -0,0 +1,363 @@
+/*******************************************************************************
+* Purpose   :  Boolean operations on large path sets, split over a grid of     *
+*              tiles and run in parallel                                       *
+* License   :  https://www.boost.org/LICENSE_1_0.txt                           *
+*******************************************************************************/
+
+#include "clipper2/clipper.h"
+#include "clipper2/clipper.tiled.h"
+#include "clipper2/clipper.parallel.h"
+#include <cmath>
+
+namespace Clipper2Lib {
+
+  // Below this many vertices a tile costs more in clipping and seam work
+  // than its thread saves.
+  const size_t tiled_min_vertices = 4096;
+  // A few tiles per thread, so one busy tile doesn't hold up the rest.
+  const size_t tiles_per_thread = 4;
+  // Result pieces reaching this close to a seam are merged across it; a
+  // seam crossing is rounded, so it may sit a unit off the seam.
+  const int64_t seam_reach = 1;
+  // Tiles clip their paths this far beyond themselves and cut the result
+  // back to the tile after the operation. Clipping subjects and clips to
+  // the very edge would give them coincident edges along it, which come
+  // out as zero-width holes joined to the seam and split real holes there.
+  const int64_t tile_margin = 16;
+
+  //------------------------------------------------------------------------------
+  // Miscellaneous methods
+  //------------------------------------------------------------------------------
+
+  static std::vector<Rect64> PathBounds(const Paths64& paths, Rect64& cover)
+  {
+    std::vector<Rect64> bounds;
+    bounds.reserve(paths.size());
+    for (const Path64& path : paths)
+    {
+      bounds.push_back(GetBounds(path));
+      if (path.size() > 2) cover += bounds.back();
+    }
+    return bounds;
+  }
+
+  // Grid lines from 'from' to 'to', 'count' cells, each at least a unit wide.
+  static std::vector<int64_t> GridLines(int64_t from, int64_t to, size_t count)
+  {
+    std::vector<int64_t> lines(count + 1);
+    double width = static_cast<double>(to - from);
+    for (size_t i = 0; i < count; ++i)
+      lines[i] = from + static_cast<int64_t>(width * i / count);
+    lines[count] = to;
+    return lines;
+  }
+
+  // The cells [first, last] of the grid 'lines' that the span lo..hi meets.
+  static void GridSpan(const std::vector<int64_t>& lines, int64_t lo, int64_t hi,
+    size_t& first, size_t& last)
+  {
+    size_t cells = lines.size() - 1;
+    first = 0;
+    while (first + 1 < cells && lines[first + 1] < lo) ++first;
+    last = first;
+    while (last + 1 < cells && lines[last + 1] <= hi) ++last;
+  }
+
+  // A result piece that reaches a seam, with the grid cell of the block
+  // it was last merged in.
+  struct SeamPiece
+  {
+    Path64 path;
+    Rect64 bounds;
+    size_t col, row;
+  };
+
+  // Adds path to 'result' if it keeps clear of the inner seams of the
+  // span x span block of tiles whose first cell is (col, row), and to
+  // 'seam' if it reaches one and so has to be merged across it.
+  static void KeepOrPend(Path64&& path, size_t col, size_t row, size_t span,
+    const std::vector<int64_t>& xs, const std::vector<int64_t>& ys,
+    Paths64& result, std::vector<SeamPiece>& seam)
+  {
+    size_t cols = xs.size() - 1, rows = ys.size() - 1;
+    size_t col_end = std::min(cols, col + span), row_end = std::min(rows, row + span);
+    Rect64 b = GetBounds(path);
+    bool on_seam =
+      (col > 0 && b.left <= xs[col] + seam_reach) ||
+      (col_end < cols && b.right >= xs[col_end] - seam_reach) ||
+      (row > 0 && b.top <= ys[row] + seam_reach) ||
+      (row_end < rows && b.bottom >= ys[row_end] - seam_reach);
+    if (on_seam)
+      seam.push_back(SeamPiece{ std::move(path), b, col, row });
+    else
+      result.push_back(std::move(path));
+  }
+
+  // Square-ish tiles over 'area', as many as 'tiles' give or take
+  // rounding; false if that leaves fewer than two.
+  static bool TileGrid(const Rect64& area, size_t tiles,
+    std::vector<int64_t>& xs, std::vector<int64_t>& ys)
+  {
+    double aspect = static_cast<double>(area.Width()) / area.Height();
+    size_t cols = static_cast<size_t>(std::max(1.0, std::round(std::sqrt(tiles * aspect))));
+    cols = std::min<size_t>(cols, area.Width());
+    size_t rows = std::min<size_t>((tiles + cols - 1) / cols, area.Height());
+    if (cols * rows < 2) return false;
+    xs = GridLines(area.left, area.right, cols);
+    ys = GridLines(area.top, area.bottom, rows);
+    return true;
+  }
+
+  // Adds the index of every path to the tiles its bounds meet; returns
+  // the number of vertices handed out.
+  static size_t BucketPaths(const Paths64& paths, const std::vector<Rect64>& bounds,
+    const Rect64& area, const std::vector<int64_t>& xs, const std::vector<int64_t>& ys,
+    std::vector<std::vector<size_t>>& buckets)
+  {
+    size_t cols = xs.size() - 1, vertices = 0;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+      const Rect64& b = bounds[i];
+      if (paths[i].size() < 3 || !area.Intersects(b)) continue;
+      size_t c0, c1, r0, r1;
+      GridSpan(xs, b.left, b.right, c0, c1);
+      GridSpan(ys, b.top, b.bottom, r0, r1);
+      for (size_t r = r0; r <= r1; ++r)
+        for (size_t c = c0; c <= c1; ++c)
+          buckets[r * cols + c].push_back(i);
+      vertices += paths[i].size() * (r1 - r0 + 1) * (c1 - c0 + 1);
+    }
+    return vertices;
+  }
+
+  // Pieces clear of their tile's seams are final; the rest are merged
+  // back a level of the grid at a time, in blocks of 2x2 tiles, then 4x4,
+  // until one block spans the grid. Each block unions its pieces per
+  // cluster of touching bounds, and what comes out clear of the block's
+  // own seams is final. A region spanning the whole area so sheds the
+  // holes and notches that crossed inner seams block by block, in
+  // parallel, and the last union only sees what crosses the middle seams.
+  // The Positive fill rule keeps holes that reach a seam (which wind
+  // negatively) from being filled in. False if a union failed.
+  static bool MergeSeams(std::vector<Paths64>& pieces,
+    const std::vector<int64_t>& xs, const std::vector<int64_t>& ys,
+    unsigned threads, Paths64& result)
+  {
+    size_t cols = xs.size() - 1, rows = ys.size() - 1;
+    std::vector<SeamPiece> seam;
+    for (size_t t = 0; t < pieces.size(); ++t)
+    {
+      for (Path64& path : pieces[t])
+        KeepOrPend(std::move(path), t % cols, t / cols, 1, xs, ys, result, seam);
+      pieces[t] = Paths64();
+    }
+
+    std::atomic<bool> failed(false);
+    for (size_t span = 2; !seam.empty(); span *= 2)
+    {
+      // the clusters of each block, as lists of indices into seam
+      size_t block_cols = (cols + span - 1) / span;
+      std::vector<std::vector<size_t>> in_block(block_cols * ((rows + span - 1) / span));
+      for (size_t i = 0; i < seam.size(); ++i)
+        in_block[(seam[i].row / span) * block_cols + seam[i].col / span].push_back(i);
+      std::vector<std::vector<size_t>> clusters;
+      for (const std::vector<size_t>& block : in_block)
+      {
+        std::vector<Rect64> bounds;
+        bounds.reserve(block.size());
+        for (size_t i : block) bounds.push_back(seam[i].bounds);
+        for (std::vector<size_t>& cluster : details::BoundsClusters(bounds))
+        {
+          for (size_t& k : cluster) k = block[k];
+          clusters.push_back(std::move(cluster));
+        }
+      }
+
+      std::vector<Paths64> merged(clusters.size());
+      details::ParallelFor(clusters.size(), threads, [&](size_t i)
+      {
+        Paths64 cluster;
+        cluster.reserve(clusters[i].size());
+        for (size_t k : clusters[i]) cluster.push_back(std::move(seam[k].path));
+        if (cluster.size() == 1)
+        {
+          merged[i] = std::move(cluster);
+          return;
+        }
+        // drops the vertices left along the seams
+        Clipper64 clipper;
+        clipper.PreserveCollinear(false);
+        clipper.AddSubject(cluster);
+        if (!clipper.Execute(ClipType::Union, FillRule::Positive, merged[i])) failed = true;
+      });
+      if (failed) return false;
+
+      std::vector<SeamPiece> next;
+      for (size_t i = 0; i < clusters.size(); ++i)
+      {
+        const SeamPiece& first = seam[clusters[i][0]];
+        size_t c = first.col / span * span, r = first.row / span * span;
+        for (Path64& path : merged[i])
+          KeepOrPend(std::move(path), c, r, span, xs, ys, result, next);
+      }
+      seam = std::move(next);
+    }
+    return true;
+  }
+
+  //------------------------------------------------------------------------------
+  // BooleanOpTiled
+  //------------------------------------------------------------------------------
+
+  Paths64 BooleanOpTiled(ClipType cliptype, FillRule fillrule,
+    const Paths64& subjects, const Paths64& clips,
+    unsigned threads, size_t tiles)
+  {
+    threads = details::ResolveThreads(threads);
+    if (tiles == 0 && threads > 1)
+    {
+      size_t vertices = 0;
+      for (const Path64& path : subjects) vertices += path.size();
+      for (const Path64& path : clips) vertices += path.size();
+      tiles = std::min(tiles_per_thread * threads, vertices / tiled_min_vertices);
+    }
+    if (tiles < 2 || cliptype == ClipType::NoClip)
+      return BooleanOp(cliptype, fillrule, subjects, clips);
+
+    // Nothing comes out of an intersection outside both inputs, or out of a
+    // difference outside the subjects; paths beyond that are dropped.
+    Rect64 subj_cover = InvalidRect64, clip_cover = InvalidRect64;
+    std::vector<Rect64> subj_bounds = PathBounds(subjects, subj_cover);
+    std::vector<Rect64> clip_bounds = PathBounds(clips, clip_cover);
+    Rect64 area = subj_cover;
+    if (cliptype == ClipType::Intersection)
+    {
+      if (!subj_cover.IsValid() || !clip_cover.IsValid() ||
+        !subj_cover.Intersects(clip_cover)) return Paths64();
+      area = Rect64(std::max(subj_cover.left, clip_cover.left),
+        std::max(subj_cover.top, clip_cover.top),
+        std::min(subj_cover.right, clip_cover.right),
+        std::min(subj_cover.bottom, clip_cover.bottom));
+    }
+    else if (cliptype != ClipType::Difference && clip_cover.IsValid())
+      area += clip_cover;
+    if (!area.IsValid()) return Paths64();
+    // a unit of margin keeps the outer tile edges off every path
+    area = Rect64(area.left - 1, area.top - 1, area.right + 1, area.bottom + 1);
+
+    std::vector<int64_t> xs, ys;
+    if (!TileGrid(area, tiles, xs, ys))
+      return BooleanOp(cliptype, fillrule, subjects, clips);
+    size_t cols = xs.size() - 1;
+    std::vector<std::vector<size_t>> subj_in(cols * (ys.size() - 1)), clip_in(subj_in.size());
+    BucketPaths(subjects, subj_bounds, area, xs, ys, subj_in);
+    BucketPaths(clips, clip_bounds, area, xs, ys, clip_in);
+
+    // Each tile clips its share of the paths to a little beyond itself,
+    // runs the operation on what is left and cuts the result to the tile,
+    // so every piece meets the seams in single straight edges.
+    std::vector<Paths64> pieces(subj_in.size());
+    std::atomic<bool> failed(false);
+    details::ParallelFor(pieces.size(), threads, [&](size_t t)
+    {
+      if (subj_in[t].empty() && (clip_in[t].empty() ||
+        cliptype == ClipType::Intersection || cliptype == ClipType::Difference))
+          return;
+      size_t c = t % cols, r = t / cols;
+      Rect64 tile(xs[c], ys[r], xs[c + 1], ys[r + 1]);
+      RectClip64 rect_clip(Rect64(tile.left - tile_margin, tile.top - tile_margin,
+        tile.right + tile_margin, tile.bottom + tile_margin));
+      Paths64 subj, clip;
+      subj.reserve(subj_in[t].size());
+      for (size_t i : subj_in[t]) subj.push_back(subjects[i]);
+      clip.reserve(clip_in[t].size());
+      for (size_t i : clip_in[t]) clip.push_back(clips[i]);
+
+      Clipper64 clipper;
+      clipper.AddSubject(rect_clip.Execute(subj));
+      clipper.AddClip(rect_clip.Execute(clip));
+      Paths64 solution;
+      Clipper64 cut;
+      if (!clipper.Execute(cliptype, fillrule, solution)) failed = true;
+      cut.AddSubject(solution);
+      cut.AddClip(Paths64{ tile.AsPath() });
+      if (!cut.Execute(ClipType::Intersection, FillRule::NonZero, pieces[t])) failed = true;
+    });
+
+    // as BooleanOp, a failed operation gives an empty result
+    Paths64 result;
+    if (failed || !MergeSeams(pieces, xs, ys, threads, result)) return Paths64();
+    return result;
+  }
+
+  PathsD BooleanOpTiled(ClipType cliptype, FillRule fillrule,
+    const PathsD& subjects, const PathsD& clips, int precision,
+    unsigned threads, size_t tiles)
+  {
+    int error_code = 0;
+    CheckPrecisionRange(precision, error_code);
+    if (error_code) return PathsD();
+    const double scale = std::pow(10, precision);
+    Paths64 result = BooleanOpTiled(cliptype, fillrule,
+      ScalePaths<int64_t, double>(subjects, scale, error_code),
+      ScalePaths<int64_t, double>(clips, scale, error_code), threads, tiles);
+    if (error_code) return PathsD();
+    return ScalePaths<double, int64_t>(result, 1 / scale, error_code);
+  }
+
+  //------------------------------------------------------------------------------
+  // UnionTiled
+  //------------------------------------------------------------------------------
+
+  bool details::UnionTiled(FillRule fillrule, const Paths64& paths, Paths64& result,
+    unsigned threads, int& error_code)
+  {
+    size_t vertices = 0;
+    for (const Path64& path : paths) vertices += path.size();
+    size_t tiles = std::min(tiles_per_thread * threads, vertices / tiled_min_vertices);
+    if (tiles < 2) return false;
+
+    Rect64 area = InvalidRect64;
+    std::vector<Rect64> bounds = PathBounds(paths, area);
+    if (!area.IsValid()) return false;
+    area = Rect64(area.left - 1, area.top - 1, area.right + 1, area.bottom + 1);
+    std::vector<int64_t> xs, ys;
+    if (!TileGrid(area, tiles, xs, ys)) return false;
+    size_t cols = xs.size() - 1;
+    std::vector<std::vector<size_t>> path_in(cols * (ys.size() - 1));
+    // tiles take their paths whole, so paths spanning many of them would
+    // cost more than the threads save
+    if (BucketPaths(paths, bounds, area, xs, ys, path_in) > 2 * vertices) return false;
+
+    // The paths can't be clipped to the tile first, as RectClip64 may get
+    // a self-intersecting path's winding wrong; the tile goes in as the
+    // clip instead, wound so that 'fillrule' fills it.
+    std::vector<Paths64> pieces(path_in.size());
+    std::atomic<bool> failed(false);
+    details::ParallelFor(pieces.size(), threads, [&](size_t t)
+    {
+      if (path_in[t].empty()) return;
+      size_t c = t % cols, r = t / cols;
+      Path64 tile = Rect64(xs[c], ys[r], xs[c + 1], ys[r + 1]).AsPath();
+      if ((Area(tile) < 0) != (fillrule == FillRule::Negative))
+        std::reverse(tile.begin(), tile.end());
+      Paths64 share;
+      share.reserve(path_in[t].size());
+      for (size_t i : path_in[t]) share.push_back(paths[i]);
+
+      Clipper64 clipper;
+      clipper.AddSubject(share);
+      clipper.AddClip(Paths64{ tile });
+      if (!clipper.Execute(ClipType::Intersection, fillrule, pieces[t])) failed = true;
+    });
+
+    result.clear();
+    if (failed || !MergeSeams(pieces, xs, ys, threads, result))
+    {
+      result.clear();
+      error_code |= undefined_error_i;
+    }
+    return true;
+  }
+
+} // namespace Clipper2Lib
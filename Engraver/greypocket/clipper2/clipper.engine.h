@@ -14,6 +14,8 @@
 #include <queue>
 #include <functional>
 #include <memory>
+#include <new>
+#include <utility>
 
 namespace Clipper2Lib {
 
@@ -88,12 +90,8 @@ namespace Clipper2Lib {
 		Rect64 bounds = {};
 		Path64 path;
 		bool is_open = false;
-
-		~OutRec() {
-			if (splits) delete splits;
-			// nb: don't delete the split pointers
-			// as these are owned by ClipperBase's outrec_list_
-		};
+		// nb: splits is owned by ClipperBase's pool and the split
+		// pointers by ClipperBase's outrec_list_
 	};
 
 	///////////////////////////////////////////////////////////////////
@@ -173,13 +171,103 @@ namespace Clipper2Lib {
 	typedef std::vector<LocalMinima_ptr> LocalMinimaList;
 	typedef std::vector<IntersectNode> IntersectNodeList;
 
+	// ObjectPool --------------------------------------------------------------
+
+	// Objects of one type carved out of blocks that outlive each clipping
+	// operation, so a clipper that is reused stops going to the heap once its
+	// blocks are big enough. Delete puts an object on a free list for New to
+	// reuse, and Reset hands every block out again from the start. Reset runs
+	// no destructors, so objects that need one must be deleted first.
+	template <typename T>
+	class ObjectPool {
+	public:
+		ObjectPool() = default;
+		ObjectPool(const ObjectPool&) = delete;
+		ObjectPool& operator=(const ObjectPool&) = delete;
+		~ObjectPool()
+		{
+			for (const Block& block : blocks_) ::operator delete(block.first);
+		}
+
+		template <typename... Args>
+		T* New(Args&&... args)
+		{
+			void* mem;
+			if (free_)
+			{
+				mem = free_;
+				free_ = free_->next;
+			}
+			else
+				mem = Take(1);
+			return new (mem) T(std::forward<Args>(args)...);
+		}
+
+		// count objects side by side; only Reset takes them back
+		T* NewArray(size_t count)
+		{
+			T* result = Take(count);
+			for (size_t i = 0; i < count; ++i) new (result + i) T();
+			return result;
+		}
+
+		void Delete(T* obj)
+		{
+			obj->~T();
+			FreeNode* node = reinterpret_cast<FreeNode*>(obj);
+			node->next = free_;
+			free_ = node;
+		}
+
+		void Reset()
+		{
+			free_ = nullptr;
+			next_ = end_ = nullptr;
+			block_ = 0;
+		}
+
+	private:
+		struct FreeNode { FreeNode* next; };
+		static_assert(sizeof(T) >= sizeof(FreeNode), "ObjectPool: type too small for the free list");
+		typedef std::pair<T*, size_t> Block;  // storage, capacity
+		// blocks start at about 16KB and double, up to 256 times that
+		static constexpr size_t first_capacity = sizeof(T) < 16384 ? 16384 / sizeof(T) : 1;
+		static constexpr size_t max_doublings = 8;
+
+		std::vector<Block> blocks_;
+		size_t block_ = 0;  // the next block to take from
+		T* next_ = nullptr;
+		T* end_ = nullptr;
+		FreeNode* free_ = nullptr;
+
+		T* Take(size_t count)
+		{
+			if (static_cast<size_t>(end_ - next_) < count)
+			{
+				if (block_ == blocks_.size() || blocks_[block_].second < count)
+				{
+					size_t capacity = std::max(count,
+						first_capacity << std::min(blocks_.size(), max_doublings));
+					T* storage = static_cast<T*>(::operator new(capacity * sizeof(T)));
+					blocks_.emplace(blocks_.begin() + block_, storage, capacity);
+				}
+				next_ = blocks_[block_].first;
+				end_ = next_ + blocks_[block_].second;
+				++block_;
+			}
+			T* result = next_;
+			next_ += count;
+			return result;
+		}
+	};
+
 	// ReuseableDataContainer64 ------------------------------------------------
 
 	class ReuseableDataContainer64 {
 	private:
 		friend class ClipperBase;
 		LocalMinimaList minima_list_;
-		std::vector<Vertex*> vertex_lists_;
+		ObjectPool<Vertex> vertex_pool_;
 		void AddLocMin(Vertex& vert, PathType polytype, bool is_open);
 	public:
 		virtual ~ReuseableDataContainer64();
@@ -201,7 +289,12 @@ namespace Clipper2Lib {
 		Active *sel_ = nullptr;
 		LocalMinimaList minima_list_;		//pointers in case of memory reallocs
 		LocalMinimaList::iterator current_locmin_iter_;
-		std::vector<Vertex*> vertex_lists_;
+		// Vertices last until Clear; the rest only until CleanUp.
+		ObjectPool<Vertex> vertex_pool_;
+		ObjectPool<Active> active_pool_;
+		ObjectPool<OutPt> outpt_pool_;
+		ObjectPool<OutRec> outrec_pool_;
+		ObjectPool<OutRecList> splits_pool_;
 		std::priority_queue<int64_t> scanline_list_;
 		IntersectNodeList intersect_nodes_;
         HorzSegmentList horz_seg_list_;
@@ -213,6 +306,10 @@ namespace Clipper2Lib {
 		void DisposeAllOutRecs();
 		void DisposeVerticesAndLocalMinima();
 		void DeleteEdges(Active*& e);
+		inline OutPt* DuplicateOp(OutPt* op, bool insert_after);
+		inline OutPt* DisposeOutPt(OutPt* op);
+		inline void DisposeOutPts(OutRec* outrec);
+		void MoveSplits(OutRec* fromOr, OutRec* toOr);
 		inline void AddLocMin(Vertex &vert, PathType polytype, bool is_open);
 		bool IsContributingClosed(const Active &e) const;
 		inline bool IsContributingOpen(const Active &e) const;
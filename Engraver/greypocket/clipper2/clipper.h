@@ -15,6 +15,7 @@
 #include "clipper2/clipper.offset.h"
 #include "clipper2/clipper.minkowski.h"
 #include "clipper2/clipper.rectclip.h"
+#include "clipper2/clipper.tiled.h"
 #include <type_traits>
 
 namespace Clipper2Lib {
@@ -131,10 +132,11 @@ namespace Clipper2Lib {
 
   inline Paths64 InflatePaths(const Paths64& paths, double delta,
     JoinType jt, EndType et, double miter_limit = 2.0,
-    double arc_tolerance = 0.0)
+    double arc_tolerance = 0.0, unsigned threads = 1)
   {
     if (!delta) return paths;
     ClipperOffset clip_offset(miter_limit, arc_tolerance);
+    clip_offset.Threads(threads);
     clip_offset.AddPaths(paths, jt, et);
     Paths64 solution;
     clip_offset.Execute(delta, solution);
@@ -143,7 +145,7 @@ namespace Clipper2Lib {
 
   inline PathsD InflatePaths(const PathsD& paths, double delta,
     JoinType jt, EndType et, double miter_limit = 2.0,
-    int precision = 2, double arc_tolerance = 0.0)
+    int precision = 2, double arc_tolerance = 0.0, unsigned threads = 1)
   {
     int error_code = 0;
     CheckPrecisionRange(precision, error_code);
@@ -151,6 +153,7 @@ namespace Clipper2Lib {
     if (error_code) return PathsD();
     const double scale = std::pow(10, precision);
     ClipperOffset clip_offset(miter_limit, arc_tolerance * scale);
+    clip_offset.Threads(threads);
     clip_offset.AddPaths(ScalePaths<int64_t,double>(paths, scale, error_code), jt, et);
     if (error_code) return PathsD();
     Paths64 solution;
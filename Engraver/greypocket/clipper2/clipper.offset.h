@@ -61,6 +61,7 @@ private:
 	double arc_tolerance_ = 0.0;
 	bool preserve_collinear_ = false;
 	bool reverse_solution_ = false;
+	unsigned threads_ = 1;
 
 #ifdef USINGZ
 	ZCallback64 zCallback64_ = nullptr;
@@ -80,6 +81,9 @@ private:
 	void OffsetOpenPath(Group& group, const Path64& path);
 	void OffsetPoint(Group& group, const Path64& path, size_t j, size_t k);
 	void DoGroupOffset(Group &group);
+	void DoGroupOffset(Group &group, size_t begin, size_t end);
+	bool OffsetGroupsParallel(unsigned threads);
+	bool UnionTiledParallel(unsigned threads, FillRule fill_rule, bool reverse);
 	void ExecuteInternal(double delta);
 public:
 	explicit ClipperOffset(double miter_limit = 2.0,
@@ -114,6 +118,19 @@ public:
 	bool ReverseSolution() const { return reverse_solution_; }
 	void ReverseSolution(bool reverse_solution) {reverse_solution_ = reverse_solution;}
 
+	//Threads: 1 (the default) runs serially and 0 uses every hardware thread.
+	//Groups, and slices of large groups, are offset concurrently into the
+	//same raw paths a serial run makes. The final union is then split over
+	//tiles, as in BooleanOpTiled: each tile unions the raw paths meeting it,
+	//clipped to itself, and the tiles' results are merged pairwise in blocks
+	//that double in size. That gives the same polygons; only where edges
+	//cross a seam can a vertex round a unit differently. Too few vertices,
+	//or paths spanning many tiles, keep the union serial. Errors from any
+	//thread end up in ErrorCode(). A delta callback keeps the offsetting
+	//serial, since it may not be thread safe.
+	unsigned Threads() const { return threads_; }
+	void Threads(unsigned threads) { threads_ = threads; }
+
 #ifdef USINGZ
 	void SetZCallback(ZCallback64 cb) { zCallback64_ = cb; }
 #endif
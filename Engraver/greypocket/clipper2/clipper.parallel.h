@@ -0,0 +1,104 @@
+/*******************************************************************************
+* Purpose   :  Thread helpers shared by the parallel offset and tiled boolean  *
+*              operations; internal to the library's .cpp files                *
+* License   :  https://www.boost.org/LICENSE_1_0.txt                           *
+*******************************************************************************/
+
+#ifndef CLIPPER_PARALLEL_H
+#define CLIPPER_PARALLEL_H
+
+#include "clipper2/clipper.core.h"
+#include <atomic>
+#include <numeric>
+#include <thread>
+
+namespace Clipper2Lib {
+namespace details {
+
+  // 0 = one per core
+  inline unsigned ResolveThreads(unsigned threads)
+  {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    return std::max(1u, threads);
+  }
+
+  // calls fn(i) for every i in [0, count) on up to 'threads' threads
+  template <typename Fn>
+  inline void ParallelFor(size_t count, unsigned threads, Fn fn)
+  {
+    threads = static_cast<unsigned>(std::min<size_t>(threads, count));
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+      for (size_t i = next++; i < count; i = next++) fn(i);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& th : pool) th.join();
+  }
+
+  // Groups rects into clusters whose bounds overlap or touch, directly or
+  // through others in the cluster: the connected components of a sweep along
+  // x. Paths in different clusters cannot interact, so unioning the clusters
+  // apart gives the same result as unioning them all together.
+  inline std::vector<std::vector<size_t>> BoundsClusters(const std::vector<Rect64>& bounds)
+  {
+    std::vector<size_t> parent(bounds.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](size_t i)
+    {
+      while (parent[i] != i) i = parent[i] = parent[parent[i]];
+      return i;
+    };
+
+    std::vector<size_t> order(bounds.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+      [&](size_t a, size_t b) { return bounds[a].left < bounds[b].left; });
+    std::vector<size_t> active;
+    for (size_t i : order)
+    {
+      const Rect64& r = bounds[i];
+      size_t kept = 0;
+      for (size_t j : active)
+      {
+        if (bounds[j].right < r.left) continue; // passed for good
+        active[kept++] = j;
+        if (bounds[j].top <= r.bottom && r.top <= bounds[j].bottom)
+          parent[find(j)] = find(i);
+      }
+      active.resize(kept);
+      active.push_back(i);
+    }
+
+    std::vector<std::vector<size_t>> clusters;
+    std::vector<size_t> cluster_of(bounds.size(), SIZE_MAX);
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+      size_t root = find(i);
+      if (cluster_of[root] == SIZE_MAX)
+      {
+        cluster_of[root] = clusters.size();
+        clusters.emplace_back();
+      }
+      clusters[cluster_of[root]].push_back(i);
+    }
+    return clusters;
+  }
+
+  // The union under 'fillrule' of paths that may self-intersect, as the
+  // raw paths of an offset do, split over tiles like BooleanOpTiled: each
+  // tile intersects the paths meeting it with itself in one sweep, and the
+  // tiles' results are merged back in blocks that double in size. Returns
+  // false, leaving 'result' alone, when there are too few vertices to
+  // split or too many paths span several tiles; a failed union sets
+  // undefined_error_i in 'error_code' and leaves 'result' empty.
+  // Defined in clipper.tiled.cpp.
+  bool UnionTiled(FillRule fillrule, const Paths64& paths, Paths64& result,
+    unsigned threads, int& error_code);
+
+} // namespace details
+} // namespace Clipper2Lib
+
+#endif // CLIPPER_PARALLEL_H
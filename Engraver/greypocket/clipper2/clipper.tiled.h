@@ -0,0 +1,46 @@
+/*******************************************************************************
+* Purpose   :  Boolean operations on large path sets, split over a grid of     *
+*              tiles and run in parallel                                       *
+* License   :  https://www.boost.org/LICENSE_1_0.txt                           *
+*******************************************************************************/
+
+#ifndef CLIPPER_TILED_H
+#define CLIPPER_TILED_H
+
+#include "clipper2/clipper.core.h"
+#include "clipper2/clipper.engine.h"
+
+namespace Clipper2Lib
+{
+
+  // Splits the bounds the operation can produce anything in into a grid of
+  // tiles, clips the paths meeting each tile to a little beyond it with
+  // RectClip64, runs the operation tile by tile on up to 'threads' threads
+  // (0 = one per core) and cuts each result back to its tile.
+  // The pieces of a result that reach a seam are then unioned back together
+  // in blocks of tiles that double in size up to the whole grid, each block
+  // finishing what keeps clear of its own seams, so contours crossing seams
+  // come back whole without one union over every seam piece at the end.
+  //
+  // 'tiles' is the number of tiles to aim for; 0 picks a few per thread once
+  // there are enough vertices to be worth it, and with one thread, or too
+  // few vertices, this is plain BooleanOp. Paths must be closed and should
+  // not self-intersect (clipping a self-intersecting path to a rectangle can
+  // change its winding inside it); the result of an earlier operation is
+  // always fine. Where a contour crosses a seam it gains the rounded
+  // crossing point, so it may differ from a single sweep by a unit there;
+  // otherwise NonZero, Positive and Negative give the paths a single sweep
+  // does. With EvenOdd, Xor or oppositely wound overlaps, regions that
+  // only touch at a point, or slivers a unit wide at a seam, can come back
+  // joined or split differently. A failed tile gives an empty result.
+  Paths64 BooleanOpTiled(ClipType cliptype, FillRule fillrule,
+    const Paths64& subjects, const Paths64& clips,
+    unsigned threads = 0, size_t tiles = 0);
+
+  PathsD BooleanOpTiled(ClipType cliptype, FillRule fillrule,
+    const PathsD& subjects, const PathsD& clips, int precision = 2,
+    unsigned threads = 0, size_t tiles = 0);
+
+} // namespace Clipper2Lib
+
+#endif // CLIPPER_TILED_H
@@ -0,0 +1,124 @@
+// finishing.cpp
+// Tip heights are a grayscale dilation of the surface by the tool, taken one
+// chord of the tool at a time. For a flat tool every chord is a plain sliding
+// max, done with van Herk/Gil-Werman in three compares per pixel whatever the
+// chord length. Ball and V chords carry a lift per column and are straight
+// max-of-differences loops over contiguous rows, kept simple enough for the
+// compiler to vectorise on any target.
+
+#include "finishing.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const float kNone = std::numeric_limits<float>::lowest();
+
+// out[x] = max(src[x - w .. x + w]), ignoring columns outside the row. The
+// padded row is cut into blocks of 2w + 1; every window spans exactly one
+// block boundary, so it is the max of a block suffix and a block prefix.
+void slidingMax(const float* src, int n, int w, float* out, std::vector<float>& pad,
+                std::vector<float>& prefix, std::vector<float>& suffix) {
+    const int k = 2 * w + 1;
+    const int len = n + 2 * w;
+    pad.assign(len, kNone);
+    std::copy(src, src + n, pad.begin() + w);
+    prefix.resize(len);
+    suffix.resize(len);
+    for (int b = 0; b < len; b += k) {
+        const int e = std::min(len, b + k);
+        prefix[b] = pad[b];
+        for (int i = b + 1; i < e; ++i) prefix[i] = std::max(prefix[i - 1], pad[i]);
+        suffix[e - 1] = pad[e - 1];
+        for (int i = e - 2; i >= b; --i) suffix[i] = std::max(suffix[i + 1], pad[i]);
+    }
+    for (int x = 0; x < n; ++x) out[x] = std::max(suffix[x], prefix[x + 2 * w]);
+}
+
+} // namespace
+
+ToolKernel makeToolKernel(const FinishSettings& settings) {
+    ToolKernel kernel;
+    double reach = settings.tool_radius / settings.pixel_size;
+    kernel.radius = std::max(0, static_cast<int>(std::floor(reach + 1e-9)));
+    const int r = kernel.radius;
+    kernel.half.resize(2 * r + 1);
+    kernel.lift.resize(2 * r + 1);
+
+    double slope = settings.shape == ToolShape::V
+                       ? 1.0 / std::tan(settings.v_angle * 0.5 * 3.14159265358979323846 / 180.0)
+                       : 0.0;
+    for (int dy = -r; dy <= r; ++dy) {
+        int half = static_cast<int>(std::floor(std::sqrt(std::max(0.0, reach * reach - dy * dy)) + 1e-9));
+        kernel.half[dy + r] = half;
+        if (settings.shape == ToolShape::Flat) continue;
+
+        std::vector<float>& lift = kernel.lift[dy + r];
+        lift.resize(2 * half + 1);
+        for (int dx = -half; dx <= half; ++dx) {
+            double d = std::hypot(dx, dy) * settings.pixel_size;
+            double rr = settings.tool_radius;
+            double z = settings.shape == ToolShape::Ball ? rr - std::sqrt(std::max(0.0, rr * rr - d * d)) : d * slope;
+            lift[dx + half] = static_cast<float>(z);
+        }
+    }
+    return kernel;
+}
+
+void toolTipRow(const float* heights, int width, int first_row, int row_count, int y,
+                const ToolKernel& kernel, float* out) {
+    std::fill(out, out + width, kNone);
+    std::vector<float> chord(width), pad, prefix, suffix;
+    const int r = kernel.radius;
+
+    for (int dy = -r; dy <= r; ++dy) {
+        int row = y + dy - first_row;
+        if (row < 0 || row >= row_count) continue;
+        const float* src = heights + static_cast<size_t>(row) * width;
+        const int half = kernel.half[dy + r];
+        const std::vector<float>& lift = kernel.lift[dy + r];
+
+        if (lift.empty()) {
+            slidingMax(src, width, half, chord.data(), pad, prefix, suffix);
+            for (int x = 0; x < width; ++x) out[x] = std::max(out[x], chord[x]);
+            continue;
+        }
+        for (int dx = -half; dx <= half; ++dx) {
+            const float l = lift[dx + half];
+            const int x0 = std::max(0, -dx);
+            const int x1 = std::min(width, width - dx);
+            const float* s = src + dx;
+            for (int x = x0; x < x1; ++x) out[x] = std::max(out[x], s[x] - l);
+        }
+    }
+}
+
+std::vector<FinishPoint> rasterRow(const float* tip, int width, int y, const FinishSettings& settings, bool reverse) {
+    std::vector<FinishPoint> points;
+    if (width <= 0) return points;
+    const double py = (y + 0.5) * settings.pixel_size;
+    auto at = [&](int x) { return FinishPoint{ (x + 0.5) * settings.pixel_size, py, tip[x] }; };
+
+    // Cone test: a point is dropped while one line from the last kept point
+    // stays within tolerance of every point since.
+    int anchor = 0;
+    points.push_back(at(0));
+    double lo = -std::numeric_limits<double>::max(), hi = std::numeric_limits<double>::max();
+    for (int x = 1; x < width; ++x) {
+        double dx = x - anchor;
+        double slope = (tip[x] - tip[anchor]) / dx;
+        if (slope < lo || slope > hi) {
+            anchor = x - 1;
+            points.push_back(at(anchor));
+            dx = 1;
+            lo = -std::numeric_limits<double>::max();
+            hi = std::numeric_limits<double>::max();
+        }
+        lo = std::max(lo, (tip[x] - settings.tolerance - tip[anchor]) / dx);
+        hi = std::min(hi, (tip[x] + settings.tolerance - tip[anchor]) / dx);
+    }
+    if (anchor != width - 1) points.push_back(at(width - 1));
+    if (reverse) std::reverse(points.begin(), points.end());
+    return points;
+}
@@ -0,0 +1,47 @@
+// finishing.h
+// Gouge-free tool-tip heights over a heightmap and raster finishing passes
+
+#ifndef FINISHING_H
+#define FINISHING_H
+
+#include <cstdint>
+#include <vector>
+
+enum class ToolShape { Flat, Ball, V };
+
+struct FinishSettings {
+    ToolShape shape = ToolShape::Ball;
+    double tool_radius = 1.0;
+    double v_angle = 90.0;      // included angle of a V tool, degrees
+    double pixel_size = 0.2;
+    double stepover = 0.2;      // between raster rows, rounded to whole pixels
+    double tolerance = 0.001;   // Z deviation allowed when dropping raster points
+};
+
+// The tool as a set of horizontal chords: for row offset dy the tool covers
+// columns -half[dy]..half[dy], and lift[dy][dx + half] is how far the tool
+// surface there sits above the tip (empty for a flat tool).
+struct ToolKernel {
+    int radius = 0;   // in pixels
+    std::vector<int> half;
+    std::vector<std::vector<float>> lift;
+};
+
+ToolKernel makeToolKernel(const FinishSettings& settings);
+
+// Tip Z for one image row: the lowest tip height at which the tool touches
+// but does not cut below the surface, i.e. the max over the footprint of
+// surface - lift. `heights` holds rows [first_row, first_row + row_count) of
+// the image; tool rows that fall outside it are outside the image and ignored.
+void toolTipRow(const float* heights, int width, int first_row, int row_count, int y,
+                const ToolKernel& kernel, float* out);
+
+struct FinishPoint {
+    double x, y, z;
+};
+
+// One raster row, points at pixel centres, with points that lie on a
+// straight line in Z (within tolerance) dropped. `reverse` runs it right to left.
+std::vector<FinishPoint> rasterRow(const float* tip, int width, int y, const FinishSettings& settings, bool reverse);
+
+#endif // FINISHING_H
@@ -0,0 +1,70 @@
+// fixedpoint.h
+// The one integer unit Clipper geometry is kept in from import to G-code
+
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <cmath>
+#include "clipper2/clipper.h"
+
+// 1 unit = 10 nm. Clipper takes the cross products behind its orientation
+// and crossing tests in double, which is exact while no coordinate
+// difference reaches 2^26 units (671 mm): each product then stays under
+// 2^52. At 1 nm a 600 mm sheet gives products near 3.6e17, past 2^53, and
+// they are rounded; a coarser unit than 10 nm would crowd the 1 um
+// tolerances the tools work to, which are 100 units here. Geometry is
+// converted once on the way in and once on the way out; everything in
+// between is Paths64, so chained operations never rescale.
+const double units_per_mm = 1e5;
+// Geometry this wide or tall, 2^26 units, is past that exactness; the
+// tools warn when an import reaches it.
+const double exact_extent_mm = 67108864 / units_per_mm;
+
+inline bool withinExactExtent(double width_mm, double height_mm) {
+    return width_mm < exact_extent_mm && height_mm < exact_extent_mm;
+}
+
+inline int64_t toUnits(double mm) {
+    return static_cast<int64_t>(std::llround(mm * units_per_mm));
+}
+
+inline Clipper2Lib::Point64 toUnits(const Clipper2Lib::PointD& p) {
+    return Clipper2Lib::Point64(toUnits(p.x), toUnits(p.y));
+}
+
+inline Clipper2Lib::Path64 toUnits(const Clipper2Lib::PathD& path) {
+    Clipper2Lib::Path64 out;
+    out.reserve(path.size());
+    for (const auto& p : path) out.push_back(toUnits(p));
+    return out;
+}
+
+inline Clipper2Lib::Paths64 toUnits(const Clipper2Lib::PathsD& paths) {
+    Clipper2Lib::Paths64 out;
+    out.reserve(paths.size());
+    for (const auto& path : paths) out.push_back(toUnits(path));
+    return out;
+}
+
+inline double toMm(double units) { return units / units_per_mm; }
+inline double toMm2(double square_units) { return square_units / (units_per_mm * units_per_mm); }
+
+inline Clipper2Lib::PointD toMm(const Clipper2Lib::Point64& p) {
+    return Clipper2Lib::PointD(toMm(static_cast<double>(p.x)), toMm(static_cast<double>(p.y)));
+}
+
+inline Clipper2Lib::PathD toMm(const Clipper2Lib::Path64& path) {
+    Clipper2Lib::PathD out;
+    out.reserve(path.size());
+    for (const auto& p : path) out.push_back(toMm(p));
+    return out;
+}
+
+inline Clipper2Lib::PathsD toMm(const Clipper2Lib::Paths64& paths) {
+    Clipper2Lib::PathsD out;
+    out.reserve(paths.size());
+    for (const auto& path : paths) out.push_back(toMm(path));
+    return out;
+}
+
+#endif // FIXEDPOINT_H
@@ -19,9 +19,28 @@ SOURCES += \
     clipper.engine.cpp \
     clipper.offset.cpp \
     clipper.rectclip.cpp \
+    clipper.tiled.cpp \
+    adaptive.cpp \
+    finishing.cpp \
+    levelplan.cpp \
+    levelset.cpp \
+    pathstore.cpp \
+    pocketing.cpp \
+    restmachining.cpp \
+    stripreader.cpp \
     main.cpp
 
 HEADERS += \
+    adaptive.h \
+    finishing.h \
+    fixedpoint.h \
+    levelplan.h \
+    levelset.h \
+    parallel.h \
+    pathstore.h \
+    pocketing.h \
+    restmachining.h \
+    stripreader.h
 
 FORMS += \
 
@@ -33,7 +52,7 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 RESOURCES +=
 
 
-LIBS += -L/Users/macbook2015/Desktop/brew/lib
+LIBS += -L/Users/macbook2015/Desktop/brew/lib -lpng -ljpeg
 
 INCLUDEPATH += /Users/macbook2015/Desktop/brew/include /Users/macbook2015/Desktop/brew/lib
 
@@ -0,0 +1,70 @@
+// levelplan.cpp
+// Gray g is cut to (255 - g) / 255 * max_depth. The region of a level at gray
+// g is every pixel with gray <= g, so the symmetric difference between two
+// levels is just the pixel count of the grays between them and never needs
+// the contours themselves.
+
+#include "levelplan.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+double depthOf(int gray, double max_depth) {
+    return (255 - gray) / 255.0 * max_depth;
+}
+
+int thresholdOf(double depth, double max_depth) {
+    return static_cast<int>(std::floor(255.0 * (1.0 - depth / max_depth) + 1e-6));
+}
+
+} // namespace
+
+LevelPlan planLevels(const std::vector<uint64_t>& histogram, const LevelPlanSettings& settings) {
+    LevelPlan plan;
+    if (histogram.size() < 256 || settings.max_depth <= 0) return plan;
+
+    // below[g]: pixels with gray <= g, i.e. the area of the level at gray g.
+    std::vector<uint64_t> below(256);
+    uint64_t sum = 0;
+    for (int g = 0; g < 256; ++g) below[g] = sum += histogram[g];
+
+    // Shallowest first, a level on every gray that is at least the resolution
+    // below the last one. Grays in between are left less than that high.
+    std::vector<int> grays;
+    double last = 0;
+    for (int g = 254; g >= 0; --g) {
+        if (histogram[g] == 0) continue;
+        double depth = depthOf(g, settings.max_depth);
+        if (depth - last < settings.resolution - 1e-9) continue;
+        grays.push_back(g);
+        last = depth;
+    }
+
+    // Deepest first, drop a level whose region is nearly the next deeper one.
+    double pixelArea = settings.pixel_size * settings.pixel_size;
+    std::vector<int> kept;
+    for (auto it = grays.rbegin(); it != grays.rend(); ++it) {
+        if (!kept.empty() && (below[*it] - below[kept.back()]) * pixelArea < settings.merge_area) continue;
+        kept.push_back(*it);
+    }
+    std::reverse(kept.begin(), kept.end());
+
+    // Step-down: split wide gaps evenly.
+    double prev = 0;
+    for (int g : kept) {
+        double depth = depthOf(g, settings.max_depth);
+        int steps = settings.max_step_down > 0
+                        ? std::max(1, static_cast<int>(std::ceil((depth - prev) / settings.max_step_down - 1e-9)))
+                        : 1;
+        for (int i = 1; i < steps; ++i) {
+            double d = prev + (depth - prev) * i / steps;
+            plan.depths.push_back(d);
+            plan.thresholds.push_back(std::max(g, thresholdOf(d, settings.max_depth)));
+        }
+        plan.depths.push_back(depth);
+        plan.thresholds.push_back(g);
+        prev = depth;
+    }
+    return plan;
+}
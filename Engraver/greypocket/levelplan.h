@@ -0,0 +1,31 @@
+// levelplan.h
+// Chooses the depth levels from the gray histogram instead of a fixed grid
+
+#ifndef LEVELPLAN_H
+#define LEVELPLAN_H
+
+#include <cstdint>
+#include <vector>
+
+struct LevelPlanSettings {
+    double max_depth = 5.0;       // depth of gray 0
+    double resolution = 1.0;      // no pixel is left more than this above its depth
+    double max_step_down = 1.0;   // between consecutive levels
+    double merge_area = 1.0;      // mm^2; a level is dropped when it differs less from the next deeper one
+    double pixel_size = 0.2;
+};
+
+// Level k cuts the pixels with gray <= thresholds[k] to depths[k], shallowest
+// first, so each level nests in the one before it.
+struct LevelPlan {
+    std::vector<double> depths;
+    std::vector<int> thresholds;
+};
+
+// histogram: 256 pixel counts. Levels sit on the gray values that occur, as
+// sparsely as the resolution allows; levels whose region differs from the next
+// deeper one by less than merge_area are merged into it, and gaps wider than
+// the step-down get evenly spaced intermediate levels.
+LevelPlan planLevels(const std::vector<uint64_t>& histogram, const LevelPlanSettings& settings);
+
+#endif // LEVELPLAN_H
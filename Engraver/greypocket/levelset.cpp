@@ -0,0 +1,206 @@
+// levelset.cpp
+// Traces the pixel boundaries of every depth level in one sweep over the image.
+// A boundary between two neighbouring pixels with level counts a < b belongs to
+// levels a..b-1 only, so the work done is proportional to the total contour
+// length instead of levels x pixels.
+
+#include "levelset.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+enum { DirPosX = 0, DirPosY = 1, DirNegX = 2, DirNegY = 3 };
+
+inline uint64_t packEdge(uint64_t x, uint64_t y, uint64_t row, int dir) {
+    return ((y * row + x) << 2) | static_cast<uint64_t>(dir);
+}
+
+// A crack between level counts a and b bounds levels min(a,b)..max(a,b)-1.
+inline void emit(LevelEdges& out, int a, int b, uint64_t edge) {
+    for (int k = std::min(a, b); k < std::max(a, b); ++k) out.levels[k].push_back(edge);
+}
+
+bool touchesRow(const Path64& path, int64_t y) {
+    for (const auto& pt : path) {
+        if (pt.y == y) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+std::vector<uint8_t> levelLookup(const std::vector<int>& thresholds) {
+    std::vector<uint8_t> lut(256, 0);
+    for (int v = 0; v < 256; ++v) {
+        int n = 0;
+        while (n < static_cast<int>(thresholds.size()) && v <= thresholds[n]) ++n;
+        lut[v] = static_cast<uint8_t>(n);
+    }
+    return lut;
+}
+
+LevelEdges collectLevelEdges(const uint8_t* pixels, int width, int height, int stride,
+                             const std::vector<uint8_t>& lut, int level_count, int y_origin) {
+    LevelEdges out;
+    out.width = width;
+    out.levels.resize(level_count);
+    const uint64_t row = static_cast<uint64_t>(width) + 1;
+
+    std::vector<uint8_t> prev(width, 0), cur(width, 0);
+    for (int y = 0; y <= height; ++y) {
+        if (y < height) {
+            const uint8_t* scan = pixels + static_cast<size_t>(y) * stride;
+            for (int x = 0; x < width; ++x) cur[x] = lut[scan[x]];
+        } else {
+            std::fill(cur.begin(), cur.end(), 0);
+        }
+        const uint64_t gy = static_cast<uint64_t>(y + y_origin);
+
+        // Horizontal cracks between row y-1 (a) and row y (b).
+        for (int x = 0; x < width; ++x) {
+            int a = prev[x], b = cur[x];
+            if (a == b) continue;
+            emit(out, a, b, b > a ? packEdge(x, gy, row, DirPosX) : packEdge(x + 1, gy, row, DirNegX));
+        }
+
+        // Vertical cracks between column x-1 (a) and column x (b) of row y.
+        if (y < height) {
+            int a = 0;
+            for (int x = 0; x <= width; ++x) {
+                int b = x < width ? cur[x] : 0;
+                if (a != b) emit(out, a, b, b > a ? packEdge(x, gy + 1, row, DirNegY) : packEdge(x, gy, row, DirPosY));
+                a = b;
+            }
+        }
+        std::swap(prev, cur);
+    }
+    return out;
+}
+
+// Edges of rows [top, y] as a run: the cracks inside each row, those between
+// its rows, and the run's top and bottom borders, where every level a pixel
+// is in has an edge.
+std::vector<int> levelEdgeRuns(const uint8_t* pixels, int width, int height, int stride,
+                               const std::vector<uint8_t>& lut, size_t max_edges) {
+    std::vector<int> starts = { 0 };
+    std::vector<uint8_t> prev(width, 0), cur(width, 0);
+    uint64_t run = 0;   // edges of the run so far, bottom border left out
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* scan = pixels + static_cast<size_t>(y) * stride;
+        uint64_t inRow = 0, border = 0, between = 0;
+        int a = 0;
+        for (int x = 0; x < width; ++x) {
+            cur[x] = lut[scan[x]];
+            inRow += std::abs(cur[x] - a);
+            border += cur[x];
+            between += std::abs(cur[x] - prev[x]);
+            a = cur[x];
+        }
+        inRow += a;
+        if (y == starts.back()) {
+            run = border + inRow;
+        } else if (run + between + inRow + border > max_edges) {
+            starts.push_back(y);
+            run = border + inRow;
+        } else {
+            run += between + inRow;
+        }
+        std::swap(prev, cur);
+    }
+    starts.push_back(height);
+    return starts;
+}
+
+Paths64 traceLevel(std::vector<uint64_t>& edges, int width, double pixel_size) {
+    static const int dx[4] = { 1, 0, -1, 0 };
+    static const int dy[4] = { 0, 1, 0, -1 };
+    const uint64_t row = static_cast<uint64_t>(width) + 1;
+    const int64_t pixel = toUnits(pixel_size);
+
+    Paths64 paths;
+    std::sort(edges.begin(), edges.end());
+    std::vector<bool> used(edges.size(), false);
+
+    for (size_t first = 0; first < edges.size(); ++first) {
+        if (used[first]) continue;
+        Path64 path;
+        size_t cur = first;
+        int lastDir = -1;
+        for (;;) {
+            used[cur] = true;
+            uint64_t vertex = edges[cur] >> 2;
+            int dir = static_cast<int>(edges[cur] & 3);
+            int64_t x = static_cast<int64_t>(vertex % row);
+            int64_t y = static_cast<int64_t>(vertex / row);
+            if (dir != lastDir) path.emplace_back(x * pixel, y * pixel);
+            lastDir = dir;
+
+            // Next edge starts where this one ends; at a checkerboard vertex
+            // two edges leave, prefer the right turn so diagonal pixels split.
+            uint64_t next = static_cast<uint64_t>(y + dy[dir]) * row + static_cast<uint64_t>(x + dx[dir]);
+            auto lo = std::lower_bound(edges.begin(), edges.end(), next << 2);
+            size_t pick = edges.size();
+            for (auto it = lo; it != edges.end() && (*it >> 2) == next; ++it) {
+                size_t idx = static_cast<size_t>(it - edges.begin());
+                if (used[idx]) continue;
+                if (pick == edges.size() || static_cast<int>(*it & 3) == ((dir + 1) & 3)) pick = idx;
+            }
+            if (pick == edges.size()) break;
+            cur = pick;
+        }
+        if (path.size() > 2 && static_cast<int>(edges[first] & 3) == lastDir) {
+            // The loop closed on a straight run: the start point is not a corner.
+            path.erase(path.begin());
+        }
+        if (path.size() > 2) paths.push_back(std::move(path));
+    }
+    return paths;
+}
+
+std::vector<Paths64> extractLevelContours(const uint8_t* pixels, int width, int height, int stride,
+                                          const std::vector<int>& thresholds, double pixel_size) {
+    int count = static_cast<int>(thresholds.size());
+    LevelEdges edges = collectLevelEdges(pixels, width, height, stride, levelLookup(thresholds), count);
+    std::vector<Paths64> contours(count);
+    parallelFor(count, [&](size_t k) {
+        contours[k] = traceLevel(edges.levels[k], width, pixel_size);
+    });
+    return contours;
+}
+
+LevelStitcher::LevelStitcher(int level_count, double pixel_size)
+    : pixel_(toUnits(pixel_size)), open_(level_count) {}
+
+void LevelStitcher::addStrip(std::vector<Paths64>& contours, int top, int bottom) {
+    int64_t seamAbove = top * pixel_;
+    int64_t seamBelow = bottom * pixel_;
+    parallelFor(open_.size(), [&](size_t k) {
+        // The pieces closed along the seam above share that edge with the
+        // open contours, which the union cancels.
+        Paths64 merge = std::move(open_[k]);
+        Paths64 pieces;
+        for (auto& path : contours[k]) {
+            (top > 0 && touchesRow(path, seamAbove) ? merge : pieces).push_back(std::move(path));
+        }
+        contours[k].clear();
+        if (!merge.empty()) {
+            Paths64 joined = Union(merge, FillRule::NonZero);
+            pieces.insert(pieces.end(), joined.begin(), joined.end());
+        }
+
+        open_[k].clear();
+        for (auto& path : pieces) {
+            (touchesRow(path, seamBelow) ? open_[k] : contours[k]).push_back(std::move(path));
+        }
+    });
+}
+
+std::vector<Paths64> LevelStitcher::finish() {
+    std::vector<Paths64> last(open_.size());
+    last.swap(open_);
+    return last;
+}
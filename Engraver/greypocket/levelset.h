@@ -0,0 +1,69 @@
+// levelset.h
+// Single-pass extraction of nested depth-level contours from a grayscale heightmap
+
+#ifndef LEVELSET_H
+#define LEVELSET_H
+
+#include <cstdint>
+#include <vector>
+#include "clipper2/clipper.h"
+#include "fixedpoint.h"
+
+// Directed pixel-boundary edges ("cracks") for every level, packed as
+// ((y * (width + 1) + x) << 2) | dir with dir 0:+x 1:+y 2:-x 3:-y.
+// Each level's edges form closed loops with the level region on one side.
+struct LevelEdges {
+    int width = 0;
+    std::vector<std::vector<uint64_t>> levels;
+};
+
+// Pixel gray -> number of levels it belongs to. Level k (0-based) holds the
+// pixels with gray <= thresholds[k]; thresholds must be non-increasing so that
+// every level is nested inside the one before it.
+std::vector<uint8_t> levelLookup(const std::vector<int>& thresholds);
+
+// Sweeps rows [0, height) once and emits the boundary edges of all levels.
+// y_origin shifts the edge coordinates so strips of a larger image line up.
+LevelEdges collectLevelEdges(const uint8_t* pixels, int width, int height, int stride,
+                             const std::vector<uint8_t>& lut, int level_count, int y_origin = 0);
+
+// Splits rows [0, height) into runs for which collectLevelEdges, called on
+// the run alone, emits at most max_edges edges over all levels; a single row
+// may go over. Returns the first row of each run, then height. The count is
+// exact, so a strip of busy detail is cut finer and a plain one stays whole.
+std::vector<int> levelEdgeRuns(const uint8_t* pixels, int width, int height, int stride,
+                               const std::vector<uint8_t>& lut, size_t max_edges);
+
+// Chains one level's edges into closed contours, in fixed-point units; pixel
+// corners land on whole units for any pixel size that is a whole number of
+// units (10 nm).
+Clipper2Lib::Paths64 traceLevel(std::vector<uint64_t>& edges, int width, double pixel_size);
+
+// Joins contours traced strip by strip. Every strip's contours are closed
+// along its first and last row, so contours touching the seam with the next
+// strip are held back and unioned with that strip's; only what crosses the
+// current seam stays open, everything else is final.
+class LevelStitcher {
+public:
+    LevelStitcher(int level_count, double pixel_size);
+
+    // Strips arrive top to bottom; top and bottom are the image rows the
+    // strip covers, [top, bottom). Takes the strip's contours out of
+    // `contours` and leaves there, per level, the contours that no later
+    // strip can change, so the caller can put them away.
+    void addStrip(std::vector<Clipper2Lib::Paths64>& contours, int top, int bottom);
+
+    // The contours still open along the last strip's bottom, per level,
+    // once the last strip is in.
+    std::vector<Clipper2Lib::Paths64> finish();
+
+private:
+    int64_t pixel_;   // pixel size in units
+    std::vector<Clipper2Lib::Paths64> open_;
+};
+
+// Convenience: all levels, outermost (shallowest) first.
+std::vector<Clipper2Lib::Paths64> extractLevelContours(const uint8_t* pixels, int width, int height, int stride,
+                                                       const std::vector<int>& thresholds, double pixel_size);
+
+#endif // LEVELSET_H
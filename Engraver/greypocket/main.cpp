@@ -2,88 +2,309 @@
 // Grayscale Heightmap to Pocketing G-code (Standalone Qt App)
 
 #include <QApplication>
-#include <QImage>
 #include <QFileDialog>
 #include <QFile>
-#include <QPainterPath>
 #include <QDebug>
 #include "clipper2/clipper.h"
-#include <QBitmap>
+#include "adaptive.h"
+#include "finishing.h"
+#include "fixedpoint.h"
+#include "levelplan.h"
+#include "levelset.h"
+#include "parallel.h"
+#include "pathstore.h"
+#include "pocketing.h"
+#include "restmachining.h"
+#include "stripreader.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
 
 using namespace Clipper2Lib;
 
 const double pixel_size_mm = 0.2; // scale: 1 pixel = 0.2 mm
-const double layer_height_mm = 1.0;
+const double layer_height_mm = 1.0; // no pixel is left more than this above its depth
+const double max_step_down_mm = 1.0;
+const double level_merge_area_mm2 = 1.0; // levels whose areas differ by less than this are merged
 const double max_depth_mm = 5.0;
-const double tool_radius_mm = 1.0;
-
-// Convert QPainterPath to Clipper Path
-PathD pathFromQPainterPath(const QPainterPath& qpath) {
-    PathD path;
-    for (int i = 0; i < qpath.elementCount(); ++i) {
-        auto el = qpath.elementAt(i);
-        path.emplace_back(el.x * pixel_size_mm, el.y * pixel_size_mm);
-    }
-    return path;
-}
+const double safe_z_mm = 5.0;
+const unsigned worker_threads = 0; // 0 = one per core
+const size_t memory_budget_mb = 512; // strips and level edges, half each; the levels being cut come on top
+const size_t strip_bytes_per_pixel = 8; // gray strip, reader buffers and finishing heights
+const size_t bytes_per_edge = 24; // packed edge and its traced corner
+const bool adaptive_clearing = false; // engagement-limited fronts instead of offset rings
+const double adaptive_engagement = 0.3; // max radial engagement, as a fraction of the tool diameter
+
+struct MillTool {
+    int number;
+    double radius_mm;
+    double stepover_mm;
+};
+
+// Roughing tool first; each following tool only cuts the stock the tools
+// before it could not reach (corners, narrow channels).
+const std::vector<MillTool> tools = {
+    { 1, 3.0, 2.4 },
+    { 2, 1.0, 0.8 },
+};
+
+// Raster finishing over the relief once the levels are pocketed; the
+// stepover is the distance between rows.
+const bool finishing_pass = false;
+const MillTool finishing_tool = { 3, 1.0, 0.2 };
+const ToolShape finishing_shape = ToolShape::Ball;
+const double finishing_v_angle = 90.0;
 
-QString generateGCode(const PathsD& layers, double depth) {
+QString generateGCode(const std::vector<CutPath>& cuts, double depth) {
     QString code;
-    code += QString("G1 Z%1 F300\n").arg(-depth);
-    for (const auto& path : layers) {
+    for (const auto& cut : cuts) {
+        const PathD path = toMm(cut.points);
         if (path.empty()) continue;
-        code += QString("G0 X%1 Y%2\n").arg(path[0].x).arg(path[0].y);
-        code += "G1 F500\n";
+        if (cut.retract) {
+            code += QString("G0 Z%1\n").arg(safe_z_mm);
+            code += QString("G0 X%1 Y%2\n").arg(path[0].x).arg(path[0].y);
+            code += QString("G1 Z%1 F300\n").arg(-depth);
+            code += "G1 F500\n";
+        } else {
+            // Stay-down link through already cleared stock.
+            code += QString("G1 X%1 Y%2\n").arg(path[0].x).arg(path[0].y);
+        }
         for (size_t i = 1; i < path.size(); ++i) {
             code += QString("G1 X%1 Y%2\n").arg(path[i].x).arg(path[i].y);
         }
-        code += "G0 Z5\n";
     }
+    if (!cuts.empty()) code += QString("G0 Z%1\n").arg(safe_z_mm);
     return code;
 }
 
+// One raster row. The first row comes down from safe Z; later rows are linked
+// at Z0, the top of the stock, which no part of the relief rises above.
+QString generateFinishCode(const std::vector<FinishPoint>& row, bool first) {
+    QString code;
+    if (row.empty()) return code;
+    if (first) {
+        code += QString("G0 Z%1\n").arg(safe_z_mm);
+        code += QString("G0 X%1 Y%2\n").arg(row[0].x).arg(row[0].y);
+        code += QString("G1 Z%1 F300\n").arg(row[0].z);
+        code += "G1 F500\n";
+    } else {
+        code += "G1 Z0\n";
+        code += QString("G1 X%1 Y%2\n").arg(row[0].x).arg(row[0].y);
+        code += QString("G1 Z%1\n").arg(row[0].z);
+    }
+    for (size_t i = 1; i < row.size(); ++i) {
+        code += QString("G1 X%1 Y%2 Z%3\n").arg(row[i].x).arg(row[i].y).arg(row[i].z);
+    }
+    return code;
+}
+
+bool readStrip(StripReader& reader, int y, int rows, std::vector<uint8_t>& strip) {
+    if (reader.readRows(y, rows, strip)) return true;
+    qWarning() << "Heightmap read failed at row" << y << ":" << reader.error();
+    return false;
+}
+
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
 
-    QString file = QFileDialog::getOpenFileName(nullptr, "Open Heightmap PNG", "", "Images (*.png *.bmp *.jpg)");
+    QString file = QFileDialog::getOpenFileName(nullptr, "Open Heightmap", "", "Images (*.png *.jpg *.jpeg *.bmp *.pgm)");
     if (file.isEmpty()) return 0;
 
-    QImage img(file);
-    if (img.isNull()) return 1;
+    StripReader reader;
+    if (!reader.open(file)) {
+        qWarning() << "Cannot read" << file << ":" << reader.error();
+        return 1;
+    }
+    int w = reader.width();
+    int h = reader.height();
+    // Levels are traced and offset in fixed point, exact only up to a span.
+    if (!withinExactExtent(w * pixel_size_mm, h * pixel_size_mm)) {
+        qWarning() << "The heightmap spans" << w * pixel_size_mm << "x" << h * pixel_size_mm << "mm; past"
+                   << exact_extent_mm << "mm the pocket offsets may misjudge where contours cross";
+    }
 
-    img = img.convertToFormat(QImage::Format_Grayscale8);
-    int w = img.width();
-    int h = img.height();
+    // The G-code goes to the file as each batch of levels is cut, so the
+    // program never holds more than one batch of it.
+    QFile out("pocket.gcode");
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Cannot write pocket.gcode";
+        return 1;
+    }
+    out.write("G21\nG90\nG0 Z5\n");
 
-    QString gcode = "G21\nG90\nG0 Z5\n";
+    size_t budget_bytes = memory_budget_mb * 1024 * 1024 / 2;
+    size_t budget_pixels = budget_bytes / strip_bytes_per_pixel;
+    size_t budget_edges = budget_bytes / bytes_per_edge;
+    int strip_rows = static_cast<int>(std::max<size_t>(1, std::min<size_t>(h, budget_pixels / w)));
+    std::vector<uint8_t> strip;
 
-    for (double depth = 0; depth <= max_depth_mm; depth += layer_height_mm) {
-        int threshold = static_cast<int>(255.0 * (depth / max_depth_mm));
+    // Darker is deeper: a pixel is cut at depth d while its target depth
+    // (255 - gray) / 255 * max_depth_mm reaches d, so each level nests in the
+    // last. The levels sit on the grays the image actually uses, so a few
+    // plateaus give a few levels.
+    std::vector<uint64_t> histogram(256, 0);
+    for (int y = 0; y < h; y += strip_rows) {
+        if (!readStrip(reader, y, std::min(strip_rows, h - y), strip)) return 1;
+        for (uint8_t v : strip) ++histogram[v];
+    }
+    LevelPlanSettings planning;
+    planning.max_depth = max_depth_mm;
+    planning.resolution = layer_height_mm;
+    planning.max_step_down = max_step_down_mm;
+    planning.merge_area = level_merge_area_mm2;
+    planning.pixel_size = pixel_size_mm;
+    LevelPlan plan = planLevels(histogram, planning);
+    const std::vector<double>& depths = plan.depths;
+    int level_count = static_cast<int>(depths.size());
+    qDebug() << "Planned" << level_count << "levels";
 
-        QImage binary = img;
-        for (int y = 0; y < h; ++y) {
-            uchar* scan = binary.scanLine(y);
-            for (int x = 0; x < w; ++x) {
-                scan[x] = (scan[x] < threshold) ? 0 : 255;
+    // The image is swept in strips sized to the memory budget; one sweep per
+    // strip finds every level's boundary, the levels are traced on the pool
+    // and stitched to the strips above. A strip with more edges than the
+    // edge budget is swept in runs of rows. Contours that no later strip can
+    // change go to disk. A small image is a single strip.
+    std::vector<uint8_t> lut = levelLookup(plan.thresholds);
+    LevelStitcher stitcher(level_count, pixel_size_mm);
+    PathStore contours;
+    auto store = [&](std::vector<Paths64>& pieces) {
+        for (int i = 0; i < level_count; ++i) contours.append(i, pieces[i]);
+    };
+    for (int y = 0; y < h; y += strip_rows) {
+        int rows = std::min(strip_rows, h - y);
+        if (!readStrip(reader, y, rows, strip)) return 1;
+        std::vector<int> runs = levelEdgeRuns(strip.data(), w, rows, w, lut, budget_edges);
+        for (size_t r = 0; r + 1 < runs.size(); ++r) {
+            int top = y + runs[r], bottom = y + runs[r + 1];
+            std::vector<Paths64> pieces(level_count);
+            {
+                LevelEdges edges = collectLevelEdges(strip.data() + static_cast<size_t>(runs[r]) * w, w,
+                                                     bottom - top, w, lut, level_count, top);
+                parallelFor(level_count, [&](size_t i) {
+                    pieces[i] = traceLevel(edges.levels[i], w, pixel_size_mm);
+                }, worker_threads);
             }
+            stitcher.addStrip(pieces, top, bottom);
+            store(pieces);
         }
+    }
+    std::vector<Paths64> last = stitcher.finish();
+    store(last);
+    last.clear();
 
-        QPainterPath path;
-        path.addRegion(QRegion(QBitmap::fromImage(binary)));
-        PathD base = pathFromQPainterPath(path);
+    // Tool-major order keeps one tool change per tool. Within a tool the
+    // levels only read what earlier tools removed, so they still run in
+    // parallel, a batch of one level per core at a time; only that batch's
+    // contours, toolpaths and G-code are in memory.
+    size_t batch = worker_threads ? worker_threads : std::max(1u, std::thread::hardware_concurrency());
+    StockModel stock(level_count);
+    stock.setThreads(worker_threads);
+    for (size_t t = 0; t < tools.size(); ++t) {
+        PocketSettings pocket;
+        pocket.tool_radius = tools[t].radius_mm;
+        pocket.stepover = tools[t].stepover_mm;
+
+        AdaptiveSettings adaptive;
+        adaptive.tool_radius = tools[t].radius_mm;
+        adaptive.max_engagement = adaptive_engagement * 2.0 * tools[t].radius_mm;
+
+        out.write(QString("G0 Z%1\nT%2 M6\n").arg(safe_z_mm).arg(tools[t].number).toUtf8());
+        double length = 0, engagement = 0;
+        for (size_t first = 0; first < static_cast<size_t>(level_count); first += batch) {
+            size_t count = std::min(batch, level_count - first);
+            std::vector<Paths64> levels(count);
+            for (size_t i = 0; i < count; ++i) levels[i] = contours.read(first + i);
+
+            // A level's rest-area booleans span the whole sheet, so they run one
+            // level at a time with every core tiling them rather than a core per
+            // level, which leaves none over for tiling once there are as many
+            // levels as cores. The first tool has no booleans, only an offset.
+            std::vector<Paths64> domains(count), rests(count);
+            auto restArea = [&](size_t i) {
+                domains[i] = stock.restDomain(t, first + i, levels[i], pocket.tool_radius);
+                if (adaptive_clearing) rests[i] = stock.restStock(t, first + i, levels[i]);
+            };
+            if (t == 0) {
+                parallelFor(count, restArea, worker_threads);
+            } else {
+                for (size_t i = 0; i < count; ++i) restArea(i);
+            }
 
-        PathsD offset = InflatePaths(PathsD{base}, -tool_radius_mm, JoinType::Round, EndType::Polygon);
-        gcode += generateGCode(offset, depth);
+            std::vector<QString> levelCode(count);
+            std::vector<double> levelLength(count, 0.0);
+            std::vector<double> levelMaxEngagement(count, 0.0);
+            parallelFor(count, [&](size_t i) {
+                Paths64 swept;
+                Paths64 domain = std::move(domains[i]);
+                std::vector<CutPath> cuts;
+                if (adaptive_clearing) {
+                    AdaptiveResult result = adaptiveClear(domain, levels[i], rests[i], adaptive, &swept);
+                    cuts = std::move(result.cuts);
+                    levelLength[i] = result.path_length;
+                    levelMaxEngagement[i] = result.max_engagement;
+                } else {
+                    cuts = pocketToolCentres(domain, pocket, &swept);
+                    for (const auto& cut : cuts) levelLength[i] += toMm(Length(cut.points));
+                }
+                stock.setRemoved(t, first + i, std::move(swept));
+                levelCode[i] = generateGCode(cuts, depths[first + i]);
+            }, worker_threads);
+
+            for (double l : levelLength) length += l;
+            for (double e : levelMaxEngagement) engagement = std::max(engagement, e);
+            for (const QString& code : levelCode) out.write(code.toUtf8());
+        }
+        qDebug() << "Tool" << tools[t].number << "cut length" << length << "mm";
+        if (adaptive_clearing) qDebug() << "Tool" << tools[t].number << "max engagement" << engagement << "mm";
+    }
+    if (contours.failed() || stock.failed()) {
+        qWarning() << "Cannot write the level contours to a temporary file";
+        return 1;
     }
 
-    gcode += "M30\n";
+    if (finishing_pass) {
+        FinishSettings finish;
+        finish.shape = finishing_shape;
+        finish.tool_radius = finishing_tool.radius_mm;
+        finish.v_angle = finishing_v_angle;
+        finish.pixel_size = pixel_size_mm;
+        finish.stepover = finishing_tool.stepover_mm;
+        ToolKernel kernel = makeToolKernel(finish);
+        int row_step = std::max(1, static_cast<int>(std::lround(finish.stepover / pixel_size_mm)));
 
-    QFile out("pocket.gcode");
-    if (out.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        out.write(gcode.toUtf8());
-        out.close();
-        qDebug() << "G-code saved to pocket.gcode";
+        float surface[256];
+        for (int g = 0; g < 256; ++g) surface[g] = static_cast<float>(-(255 - g) / 255.0 * max_depth_mm);
+
+        // Same strips as the levels, each read with a tool radius of rows
+        // above and below so the rows near its edges see the whole tool.
+        // Raster rows are independent and run on the pool; each strip's rows
+        // go to the file before the next strip is read.
+        out.write(QString("G0 Z%1\nT%2 M6\n").arg(safe_z_mm).arg(finishing_tool.number).toUtf8());
+        std::vector<float> heights;
+        for (int y = 0; y < h; y += strip_rows) {
+            int rows = std::min(strip_rows, h - y);
+            int top = std::max(0, y - kernel.radius);
+            int bottom = std::min(h, y + rows + kernel.radius);
+            if (!readStrip(reader, top, bottom - top, strip)) return 1;
+            heights.resize(strip.size());
+            for (size_t i = 0; i < strip.size(); ++i) heights[i] = surface[strip[i]];
+
+            std::vector<int> passRows;
+            for (int r = (y + row_step - 1) / row_step * row_step; r < y + rows; r += row_step) passRows.push_back(r);
+            std::vector<QString> rowCode(passRows.size());
+            parallelFor(passRows.size(), [&](size_t i) {
+                std::vector<float> tip(w);
+                toolTipRow(heights.data(), w, top, bottom - top, passRows[i], kernel, tip.data());
+                bool reverse = (passRows[i] / row_step) % 2 == 1;
+                rowCode[i] = generateFinishCode(rasterRow(tip.data(), w, passRows[i], finish, reverse), passRows[i] == 0);
+            }, worker_threads);
+            for (const QString& code : rowCode) out.write(code.toUtf8());
+        }
+        out.write(QString("G0 Z%1\n").arg(safe_z_mm).toUtf8());
     }
 
+    out.write("M30\n");
+    out.close();
+    qDebug() << "G-code saved to pocket.gcode";
+
     return 0;
 }
@@ -0,0 +1,35 @@
+// parallel.h
+// Minimal worker pool for independent per-level jobs
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Calls fn(i) for every i in [0, count) on up to `threads` workers (0 = one per
+// core). Jobs are claimed in index order; callers write results into slot i so
+// the combined output does not depend on scheduling.
+template <typename Fn>
+void parallelFor(size_t count, Fn fn, unsigned threads = 0) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, count));
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) fn(i);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,57 @@
+// pathstore.cpp
+// Each path is its point count followed by the x, y pairs, as raw int64.
+
+#include "pathstore.h"
+
+using namespace Clipper2Lib;
+
+PathStore::PathStore() : file_(std::tmpfile()) {
+    failed_ = file_ == nullptr;
+}
+
+PathStore::~PathStore() {
+    if (file_) std::fclose(file_);
+}
+
+bool PathStore::failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+}
+
+void PathStore::append(size_t slot, const Paths64& paths) {
+    if (paths.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failed_) return;
+    if (std::fseek(file_, 0, SEEK_END) != 0) {
+        failed_ = true;
+        return;
+    }
+    Chunk chunk = { std::ftell(file_), paths.size() };
+    for (const auto& path : paths) {
+        uint64_t count = path.size();
+        if (std::fwrite(&count, sizeof(count), 1, file_) != 1 ||
+            std::fwrite(path.data(), sizeof(Point64), path.size(), file_) != path.size()) {
+            failed_ = true;
+            return;
+        }
+    }
+    if (slot >= chunks_.size()) chunks_.resize(slot + 1);
+    chunks_[slot].push_back(chunk);
+}
+
+Paths64 PathStore::read(size_t slot) const {
+    Paths64 paths;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failed_ || slot >= chunks_.size()) return paths;
+    for (const Chunk& chunk : chunks_[slot]) {
+        if (std::fseek(file_, chunk.offset, SEEK_SET) != 0) return Paths64();
+        for (size_t i = 0; i < chunk.paths; ++i) {
+            uint64_t count = 0;
+            if (std::fread(&count, sizeof(count), 1, file_) != 1) return Paths64();
+            Path64 path(count);
+            if (std::fread(path.data(), sizeof(Point64), count, file_) != count) return Paths64();
+            paths.push_back(std::move(path));
+        }
+    }
+    return paths;
+}
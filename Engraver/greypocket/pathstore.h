@@ -0,0 +1,42 @@
+// pathstore.h
+// Paths kept in a temporary file instead of memory, read back one slot at a time
+
+#ifndef PATHSTORE_H
+#define PATHSTORE_H
+
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#include "clipper2/clipper.h"
+
+// Each slot (a level, or a tool and level) collects the paths appended to it
+// and hands them all back on read. Only the file offsets stay in memory, so
+// a big sheet's contours cost disk, not RAM. append and read may be called
+// from several threads.
+class PathStore {
+public:
+    PathStore();
+    ~PathStore();
+    PathStore(const PathStore&) = delete;
+    PathStore& operator=(const PathStore&) = delete;
+
+    // True once the temporary file could not be created or written; the
+    // store then reads back empty.
+    bool failed() const;
+
+    void append(size_t slot, const Clipper2Lib::Paths64& paths);
+    Clipper2Lib::Paths64 read(size_t slot) const;
+
+private:
+    struct Chunk {
+        long offset;
+        size_t paths;
+    };
+
+    mutable std::mutex mutex_;
+    std::FILE* file_;
+    bool failed_ = false;
+    std::vector<std::vector<Chunk>> chunks_;   // per slot, in append order
+};
+
+#endif // PATHSTORE_H
@@ -0,0 +1,235 @@
+// pocketing.cpp
+// Offset-tree pocketing: every connected offset region is offset again by the
+// stepover to get its children, so the tree falls out of the recursion without
+// any containment tests. Cutting the tree bottom-up keeps the plunge in the
+// middle of each island of stock and finishes on the wall.
+
+#include "pocketing.h"
+#include <algorithm>
+#include <limits>
+
+using namespace Clipper2Lib;
+
+std::vector<Paths64> splitComponents(const Paths64& paths) {
+    std::vector<Paths64> comps;
+    if (paths.empty()) return comps;
+    PolyTree64 tree;
+    BooleanOp(ClipType::Union, FillRule::NonZero, paths, Paths64(), tree);
+
+    std::vector<const PolyPath64*> stack;
+    for (const auto& child : tree) stack.push_back(child.get());
+    while (!stack.empty()) {
+        const PolyPath64* outer = stack.back();
+        stack.pop_back();
+        Paths64 comp{ outer->Polygon() };
+        for (const auto& hole : *outer) {
+            comp.push_back(hole->Polygon());
+            for (const auto& island : *hole) stack.push_back(island.get());
+        }
+        comps.push_back(std::move(comp));
+    }
+    return comps;
+}
+
+namespace {
+
+// Links through cleared stock may clip its edge by this much, in mm.
+const double link_allowance = 0.02;
+// Deviation allowed when thinning an inset, in mm.
+const double inset_tolerance = 0.001;
+
+double distanceSqr(const Point64& a, const Point64& b) {
+    double dx = static_cast<double>(a.x - b.x), dy = static_cast<double>(a.y - b.y);
+    return dx * dx + dy * dy;
+}
+
+// Closest point on the closed ring to pt, as the edge index it lies on and the point.
+std::pair<size_t, Point64> nearestOnRing(const Path64& ring, const Point64& pt) {
+    std::pair<size_t, Point64> best(0, ring.front());
+    double bestDist = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < ring.size(); ++i) {
+        const Point64& a = ring[i];
+        const Point64& b = ring[(i + 1) % ring.size()];
+        double vx = static_cast<double>(b.x - a.x), vy = static_cast<double>(b.y - a.y);
+        double len = vx * vx + vy * vy;
+        double t = len > 0 ? ((pt.x - a.x) * vx + (pt.y - a.y) * vy) / len : 0;
+        t = std::max(0.0, std::min(1.0, t));
+        Point64 q(a.x + t * vx, a.y + t * vy);
+        double d = distanceSqr(q, pt);
+        if (d < bestDist) { bestDist = d; best = { i, q }; }
+    }
+    return best;
+}
+
+// Whether the segment a-b passes through rect (Liang-Barsky).
+bool segmentMeetsRect(const Point64& a, const Point64& b, const Rect64& rect) {
+    double t0 = 0.0, t1 = 1.0;
+    double dx = static_cast<double>(b.x - a.x), dy = static_cast<double>(b.y - a.y);
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { static_cast<double>(a.x - rect.left), static_cast<double>(rect.right - a.x),
+                          static_cast<double>(a.y - rect.top), static_cast<double>(rect.bottom - a.y) };
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return false;
+        } else {
+            double t = q[i] / p[i];
+            if (p[i] < 0.0) t0 = std::max(t0, t);
+            else t1 = std::min(t1, t);
+            if (t0 > t1) return false;
+        }
+    }
+    return true;
+}
+
+class PocketBuilder {
+public:
+    PocketBuilder(const PocketSettings& settings)
+        : radius(settings.tool_radius * units_per_mm),
+          step(std::min(settings.stepover, settings.tool_radius) * units_per_mm) {}
+
+    std::vector<CutPath> run(const Paths64& domain, Paths64* swept) {
+        std::vector<Paths64> comps = splitComponents(domain);
+        cutSiblings(comps);
+        if (swept) *swept = mergeFinished(0);
+        return std::move(out);
+    }
+
+private:
+    // The swept area of a subtree that has been cut, waiting to be merged
+    // into its parent's.
+    struct Cleared {
+        Paths64 area;
+        Rect64 bounds;
+    };
+
+    double radius, step;   // units
+    std::vector<CutPath> out;
+    // Swept area of the component being cut, grown ring by ring. Each
+    // component starts afresh and is unioned into its parent's once, when
+    // the parent's own rings start, so a ring is never unioned with stock
+    // cleared elsewhere.
+    Paths64 cleared;
+    std::vector<Cleared> finished;   // cut subtrees not yet merged, innermost last
+    Point64 last;
+    bool haveLast = false;
+
+    void cutSiblings(std::vector<Paths64>& comps) {
+        // Nearest-neighbour over the sibling subtrees, measured to their outer ring.
+        while (!comps.empty()) {
+            size_t pick = 0;
+            if (haveLast) {
+                double best = std::numeric_limits<double>::max();
+                for (size_t i = 0; i < comps.size(); ++i) {
+                    double d = distanceSqr(nearestOnRing(comps[i].front(), last).second, last);
+                    if (d < best) { best = d; pick = i; }
+                }
+            }
+            Paths64 comp = std::move(comps[pick]);
+            comps.erase(comps.begin() + pick);
+            cutComponent(comp);
+            finished.push_back({ std::move(cleared), Rect64() });
+            finished.back().bounds = GetBounds(finished.back().area);
+            cleared.clear();
+        }
+    }
+
+    // Unions finished[from..] into one area and drops them from the list.
+    Paths64 mergeFinished(size_t from) {
+        Paths64 merged;
+        if (finished.size() == from + 1) {
+            merged = std::move(finished.back().area);
+        } else if (finished.size() > from + 1) {
+            Clipper64 clipper;
+            for (size_t i = from; i < finished.size(); ++i) clipper.AddSubject(finished[i].area);
+            clipper.Execute(ClipType::Union, FillRule::NonZero, merged);
+        }
+        finished.resize(from);
+        return merged;
+    }
+
+    void cutComponent(const Paths64& comp) {
+        // Thinned to a micron, or the arcs of each inset multiply down the tree.
+        Paths64 inset = SimplifyPaths(InflatePaths(comp, -step, JoinType::Round, EndType::Polygon),
+                                      inset_tolerance * units_per_mm);
+        std::vector<Paths64> children = splitComponents(inset);
+        size_t mark = finished.size();
+        cutSiblings(children);
+        cleared = mergeFinished(mark);
+
+        std::vector<Path64> rings(comp.begin(), comp.end());
+        while (!rings.empty()) {
+            size_t pick = 0;
+            if (haveLast) {
+                double best = std::numeric_limits<double>::max();
+                for (size_t i = 0; i < rings.size(); ++i) {
+                    double d = distanceSqr(nearestOnRing(rings[i], last).second, last);
+                    if (d < best) { best = d; pick = i; }
+                }
+            }
+            cutRing(rings[pick]);
+            rings.erase(rings.begin() + pick);
+        }
+    }
+
+    void cutRing(const Path64& ring) {
+        if (ring.size() < 2) return;
+        // Enter at the point of the ring closest to where the tool is, which
+        // is one stepover away from the ring just cut.
+        CutPath cut;
+        cut.points.reserve(ring.size() + 2);
+        if (haveLast) {
+            auto entry = nearestOnRing(ring, last);
+            cut.points.push_back(entry.second);
+            for (size_t i = 1; i <= ring.size(); ++i) {
+                const Point64& pt = ring[(entry.first + i) % ring.size()];
+                if (pt != cut.points.back()) cut.points.push_back(pt);
+            }
+            if (cut.points.back() != entry.second) cut.points.push_back(entry.second);
+        } else {
+            cut.points = ring;
+            cut.points.push_back(ring.front());
+        }
+        cut.retract = !haveLast || !linkIsCleared(last, cut.points.front());
+        out.push_back(cut);
+
+        // The ring sweeps a band of tool radius either side of it.
+        Paths64 band = InflatePaths(Paths64{ cut.points }, radius, JoinType::Round, EndType::Joined);
+        cleared = Union(cleared, band, FillRule::NonZero);
+        last = cut.points.back();
+        haveLast = true;
+    }
+
+    bool linkIsCleared(const Point64& from, const Point64& to) const {
+        // Areas are unions, so NonZero over several of them is their union.
+        Clipper64 clipper;
+        bool any = !cleared.empty();
+        clipper.AddClip(cleared);
+        for (const Cleared& other : finished) {
+            if (!segmentMeetsRect(from, to, other.bounds)) continue;
+            clipper.AddClip(other.area);
+            any = true;
+        }
+        if (!any) return false;
+        clipper.AddOpenSubject(Paths64{ Path64{ from, to } });
+        Paths64 closed, open;
+        clipper.Execute(ClipType::Difference, FillRule::NonZero, closed, open);
+        for (const auto& part : open) {
+            if (part.size() >= 2 && Length(part) > link_allowance * units_per_mm) return false;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+std::vector<CutPath> pocketRegion(const Paths64& region, const PocketSettings& settings, Paths64* swept) {
+    if (settings.tool_radius <= 0) return {};
+    return pocketToolCentres(InflatePaths(region, -settings.tool_radius * units_per_mm, JoinType::Round, EndType::Polygon),
+                             settings, swept);
+}
+
+std::vector<CutPath> pocketToolCentres(const Paths64& domain, const PocketSettings& settings, Paths64* swept) {
+    if (swept) swept->clear();
+    if (domain.empty() || settings.tool_radius <= 0 || settings.stepover <= 0) return {};
+    return PocketBuilder(settings).run(domain, swept);
+}
@@ -0,0 +1,40 @@
+// pocketing.h
+// Concentric pocket clearing with stay-down linking between offset rings
+
+#ifndef POCKETING_H
+#define POCKETING_H
+
+#include <vector>
+#include "clipper2/clipper.h"
+#include "fixedpoint.h"
+
+// Lengths in mm; the geometry itself is in fixed-point units.
+struct PocketSettings {
+    double tool_radius = 1.0;
+    double stepover = 0.8;   // clamped to tool_radius so neighbouring rings always overlap
+};
+
+// One feed move sequence. When retract is false the tool stays at depth and
+// feeds straight from the previous path's end to points.front().
+struct CutPath {
+    Clipper2Lib::Path64 points;
+    bool retract = true;
+};
+
+// Splits a polygon set into connected components, each an outer contour
+// followed by its holes.
+std::vector<Clipper2Lib::Paths64> splitComponents(const Clipper2Lib::Paths64& paths);
+
+// Clears the whole region (closed contours, holes as reversed paths) with
+// inward offsets. Rings are ordered by the offset tree: each ring's children
+// are cut before it, innermost first, and linked without lifting whenever the
+// link stays inside the area the tool has already swept.
+// When swept is given it receives the area the tool passed over.
+std::vector<CutPath> pocketRegion(const Clipper2Lib::Paths64& region, const PocketSettings& settings,
+                                  Clipper2Lib::Paths64* swept = nullptr);
+
+// Same, starting from the tool-centre area instead of the material region.
+std::vector<CutPath> pocketToolCentres(const Clipper2Lib::Paths64& domain, const PocketSettings& settings,
+                                       Clipper2Lib::Paths64* swept = nullptr);
+
+#endif // POCKETING_H
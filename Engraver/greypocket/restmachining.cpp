@@ -0,0 +1,49 @@
+// restmachining.cpp
+// Rest area = what the tool can reach at this level minus what earlier tools
+// already removed there, with slivers along shared walls opened away.
+
+#include "restmachining.h"
+
+using namespace Clipper2Lib;
+
+StockModel::StockModel(size_t level_count, double min_width)
+    : min_width_(min_width * units_per_mm), level_count_(level_count) {}
+
+Paths64 StockModel::restDomain(size_t tool, size_t level, const Paths64& region, double tool_radius_mm) const {
+    double tool_radius = tool_radius_mm * units_per_mm;
+    Paths64 centres = InflatePaths(region, -tool_radius, JoinType::Round, EndType::Polygon);
+    if (tool == 0 || centres.empty()) return centres;
+
+    Paths64 done = removedBefore(tool, level);
+    if (done.empty()) return centres;
+
+    // Stock this tool could touch that is still standing.
+    Paths64 reach = InflatePaths(centres, tool_radius, JoinType::Round, EndType::Polygon);
+    Paths64 rest = BooleanOpTiled(ClipType::Difference, FillRule::NonZero, reach, done, threads_);
+    double half = min_width_ / 2.0;
+    rest = InflatePaths(InflatePaths(rest, -half, JoinType::Round, EndType::Polygon), half, JoinType::Round, EndType::Polygon);
+    if (rest.empty()) return rest;
+
+    // Only the tool positions that actually touch the rest stock.
+    return BooleanOpTiled(ClipType::Intersection, FillRule::NonZero, centres,
+                          InflatePaths(rest, tool_radius, JoinType::Round, EndType::Polygon), threads_);
+}
+
+Paths64 StockModel::restStock(size_t tool, size_t level, const Paths64& region) const {
+    Paths64 done = removedBefore(tool, level);
+    if (done.empty()) return region;
+    return BooleanOpTiled(ClipType::Difference, FillRule::NonZero, region, done, threads_);
+}
+
+Paths64 StockModel::removedBefore(size_t tool, size_t level) const {
+    Paths64 done;
+    for (size_t t = 0; t < tool; ++t) {
+        Paths64 swept = removed(t, level);
+        done.insert(done.end(), swept.begin(), swept.end());
+    }
+    return done;
+}
+
+void StockModel::setRemoved(size_t tool, size_t level, Paths64 swept) {
+    removed_.append(tool * level_count_ + level, swept);
+}
@@ -0,0 +1,50 @@
+// restmachining.h
+// Removed-material bookkeeping so each tool only cuts stock that is still there
+
+#ifndef RESTMACHINING_H
+#define RESTMACHINING_H
+
+#include <vector>
+#include "clipper2/clipper.h"
+#include "fixedpoint.h"
+#include "pathstore.h"
+
+// Holds, per tool and level, the area that tool swept. Tools run largest
+// first; a later (smaller) tool at a level only gets the part of the level it
+// can reach that none of the earlier tools removed. Widths and radii are in
+// mm, the geometry in fixed-point units. The swept areas go to a temporary
+// file, so only the levels being worked on are in memory.
+class StockModel {
+public:
+    StockModel(size_t level_count, double min_width = 0.05);
+
+    // Tool-centre area for `tool` at `level`, empty when nothing is left.
+    Clipper2Lib::Paths64 restDomain(size_t tool, size_t level, const Clipper2Lib::Paths64& region,
+                                    double tool_radius) const;
+
+    // The part of the level still standing when `tool` starts.
+    Clipper2Lib::Paths64 restStock(size_t tool, size_t level, const Clipper2Lib::Paths64& region) const;
+
+    // Safe to call for different (tool, level) slots from several threads.
+    void setRemoved(size_t tool, size_t level, Clipper2Lib::Paths64 swept);
+
+    Clipper2Lib::Paths64 removed(size_t tool, size_t level) const { return removed_.read(tool * level_count_ + level); }
+
+    // True when the swept areas could not be written out.
+    bool failed() const { return removed_.failed(); }
+
+    // Threads for each rest-area boolean (0 = one per core); with more than
+    // one, the booleans are split into tiles. Give it the cores only when
+    // the calls are not themselves spread over threads.
+    void setThreads(unsigned threads) { threads_ = threads; }
+
+private:
+    Clipper2Lib::Paths64 removedBefore(size_t tool, size_t level) const;
+
+    double min_width_;   // units; rest stock narrower than this is left as a cusp
+    unsigned threads_ = 1;
+    size_t level_count_;
+    PathStore removed_;
+};
+
+#endif // RESTMACHINING_H
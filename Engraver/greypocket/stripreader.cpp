@@ -0,0 +1,433 @@
+// stripreader.cpp
+// The PGM and BMP paths seek to the rows they need. PNG and JPEG rows come out of a
+// decoder in order, so reading the image top to bottom costs one decode and
+// the decoder holds a few rows at most; each of greypocket's passes over the
+// image is one such decode. libpng and libjpeg report errors by longjmp, so
+// no C++ object with a destructor may live in a frame they can jump out of.
+
+#include "stripreader.h"
+#include <algorithm>
+#include <cctype>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <jpeglib.h>
+#include <png.h>
+
+class RowDecoder {
+public:
+    explicit RowDecoder(const std::string& path) : path_(path) {}
+    virtual ~RowDecoder() {}
+
+    // (Re)opens the file positioned at the first row.
+    virtual bool start() = 0;
+    // The next row, width() gray bytes.
+    virtual bool readRow(uint8_t* row) = 0;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    const char* error() const { return error_; }
+
+protected:
+    std::string path_;
+    int width_ = 0, height_ = 0;
+    char error_[JMSG_LENGTH_MAX] = "";
+};
+
+namespace {
+
+void setError(char* error, const char* message) {
+    std::snprintf(error, JMSG_LENGTH_MAX, "%s", message);
+}
+
+// Color and 16-bit input is reduced to 8-bit gray by libpng as rows are read.
+class PngDecoder : public RowDecoder {
+public:
+    using RowDecoder::RowDecoder;
+    ~PngDecoder() override { close(); }
+
+    bool start() override {
+        close();
+        file_ = std::fopen(path_.c_str(), "rb");
+        if (!file_) {
+            setError(error_, "cannot open file");
+            return false;
+        }
+        png_ = png_create_read_struct(PNG_LIBPNG_VER_STRING, this, onError, nullptr);
+        info_ = png_ ? png_create_info_struct(png_) : nullptr;
+        if (!info_) {
+            setError(error_, "out of memory");
+            return false;
+        }
+        if (setjmp(png_jmpbuf(png_))) return false;
+        png_init_io(png_, file_);
+        png_read_info(png_, info_);
+
+        if (png_get_interlace_type(png_, info_) != PNG_INTERLACE_NONE) {
+            setError(error_, "interlaced PNG cannot be read in strips; save it without interlacing");
+            return false;
+        }
+        png_byte color = png_get_color_type(png_, info_);
+        if (color == PNG_COLOR_TYPE_PALETTE) png_set_palette_to_rgb(png_);
+        if (color == PNG_COLOR_TYPE_GRAY && png_get_bit_depth(png_, info_) < 8) png_set_expand_gray_1_2_4_to_8(png_);
+        if (png_get_bit_depth(png_, info_) == 16) png_set_strip_16(png_);
+        if (color & PNG_COLOR_MASK_ALPHA) png_set_strip_alpha(png_);
+        if (color & PNG_COLOR_MASK_COLOR) png_set_rgb_to_gray_fixed(png_, 1, -1, -1);
+        png_read_update_info(png_, info_);
+
+        width_ = static_cast<int>(png_get_image_width(png_, info_));
+        height_ = static_cast<int>(png_get_image_height(png_, info_));
+        if (png_get_rowbytes(png_, info_) != static_cast<size_t>(width_)) {
+            setError(error_, "unsupported PNG pixel format");
+            return false;
+        }
+        return true;
+    }
+
+    bool readRow(uint8_t* row) override {
+        if (setjmp(png_jmpbuf(png_))) return false;
+        png_read_row(png_, row, nullptr);
+        return true;
+    }
+
+private:
+    static void onError(png_structp png, png_const_charp message) {
+        setError(static_cast<PngDecoder*>(png_get_error_ptr(png))->error_, message);
+        png_longjmp(png, 1);
+    }
+
+    void close() {
+        if (png_) png_destroy_read_struct(&png_, info_ ? &info_ : nullptr, nullptr);
+        png_ = nullptr;
+        info_ = nullptr;
+        if (file_) std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    FILE* file_ = nullptr;
+    png_structp png_ = nullptr;
+    png_infop info_ = nullptr;
+};
+
+// libjpeg decodes straight to its luminance channel, which for a YCbCr
+// JPEG skips the color conversion altogether.
+class JpegDecoder : public RowDecoder {
+public:
+    using RowDecoder::RowDecoder;
+    ~JpegDecoder() override { close(); }
+
+    bool start() override {
+        close();
+        file_ = std::fopen(path_.c_str(), "rb");
+        if (!file_) {
+            setError(error_, "cannot open file");
+            return false;
+        }
+        jpeg_.err = jpeg_std_error(&errors_.manager);
+        errors_.manager.error_exit = onError;
+        errors_.owner = this;
+        if (setjmp(errors_.jump)) return false;
+        jpeg_create_decompress(&jpeg_);
+        created_ = true;
+        jpeg_stdio_src(&jpeg_, file_);
+        jpeg_read_header(&jpeg_, TRUE);
+        // A progressive JPEG only has its final pixels once every scan is in,
+        // so libjpeg would buffer the whole image.
+        if (jpeg_has_multiple_scans(&jpeg_)) {
+            setError(error_, "progressive JPEG cannot be read in strips; save it as baseline JPEG");
+            return false;
+        }
+        jpeg_.out_color_space = JCS_GRAYSCALE;
+        jpeg_start_decompress(&jpeg_);
+        width_ = static_cast<int>(jpeg_.output_width);
+        height_ = static_cast<int>(jpeg_.output_height);
+        return true;
+    }
+
+    bool readRow(uint8_t* row) override {
+        if (setjmp(errors_.jump)) return false;
+        JSAMPROW rows[1] = { row };
+        return jpeg_read_scanlines(&jpeg_, rows, 1) == 1;
+    }
+
+private:
+    struct ErrorJump {
+        jpeg_error_mgr manager;
+        jmp_buf jump;
+        JpegDecoder* owner;
+    };
+
+    static void onError(j_common_ptr jpeg) {
+        ErrorJump* errors = reinterpret_cast<ErrorJump*>(jpeg->err);
+        (*jpeg->err->format_message)(jpeg, errors->owner->error_);
+        std::longjmp(errors->jump, 1);
+    }
+
+    void close() {
+        if (created_) jpeg_destroy_decompress(&jpeg_);
+        created_ = false;
+        if (file_) std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    FILE* file_ = nullptr;
+    jpeg_decompress_struct jpeg_;
+    ErrorJump errors_;
+    bool created_ = false;
+};
+
+uint32_t little(const uint8_t* p, int bytes) {
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+// Rec. 709 weights, as libpng uses for PNG.
+uint8_t grayOf(unsigned r, unsigned g, unsigned b) {
+    return static_cast<uint8_t>((54 * r + 183 * g + 19 * b + 128) >> 8);
+}
+
+// A channel of a 32-bit pixel scaled to 0..255 by its mask.
+unsigned channel(uint32_t pixel, uint32_t mask) {
+    if (!mask) return 0;
+    int shift = 0;
+    while (!((mask >> shift) & 1)) ++shift;
+    uint32_t max = mask >> shift;
+    return static_cast<unsigned>(static_cast<uint64_t>((pixel & mask) >> shift) * 255u / max);
+}
+
+} // namespace
+
+StripReader::StripReader() {}
+StripReader::~StripReader() {}
+
+bool StripReader::open(const QString& file) {
+    error_.clear();
+    decoder_.reset();
+    isBmp_ = false;
+    file_.close();
+    file_.setFileName(file);
+    if (!file_.open(QIODevice::ReadOnly)) {
+        error_ = file_.errorString();
+        return false;
+    }
+    QByteArray magic = file_.peek(8);
+    if (magic.startsWith("P5")) {
+        if (openPgm()) return true;
+        error_ = "malformed binary PGM header";
+        return false;
+    }
+    if (magic.startsWith("BM")) {
+        if (openBmp()) return true;
+        if (error_.isEmpty()) error_ = "malformed BMP header";
+        return false;
+    }
+    file_.close();
+
+    std::string path = QFile::encodeName(file).toStdString();
+    if (magic.startsWith("\x89PNG\r\n\x1a\n")) {
+        decoder_.reset(new PngDecoder(path));
+    } else if (magic.startsWith("\xff\xd8\xff")) {
+        decoder_.reset(new JpegDecoder(path));
+    } else {
+        error_ = "only PNG, JPEG, BMP and binary PGM heightmaps can be read in strips";
+        return false;
+    }
+    if (!decoder_->start()) {
+        error_ = QString::fromLocal8Bit(decoder_->error());
+        decoder_.reset();
+        return false;
+    }
+    width_ = decoder_->width();
+    height_ = decoder_->height();
+    next_ = 0;
+    tail_.clear();
+    tailY_ = 0;
+    return width_ > 0 && height_ > 0;
+}
+
+bool StripReader::readRows(int y, int count, std::vector<uint8_t>& out) {
+    if (y < 0 || count <= 0 || y + count > height_) return false;
+    if (decoder_) return readDecodedRows(y, count, out);
+    if (isBmp_) return readBmpRows(y, count, out);
+    return readPgmRows(y, count, out);
+}
+
+// The rows of the last read are kept, so strips that overlap the one
+// before (the finishing pass reads a tool radius of rows either side) go
+// on decoding where it stopped.
+bool StripReader::readDecodedRows(int y, int count, std::vector<uint8_t>& out) {
+    const size_t row = static_cast<size_t>(width_);
+    out.resize(row * count);
+    int have = 0;   // rows of out filled so far
+    if (y >= tailY_ && y < next_) {
+        have = std::min(count, next_ - y);
+        std::copy(tail_.begin() + (y - tailY_) * row, tail_.begin() + (y - tailY_ + have) * row, out.begin());
+        if (have == count) return true;
+    } else if (y < next_) {
+        next_ = 0;
+        if (!decoder_->start()) return decodeFailed();
+    }
+    // Rows above y are decoded into out and overwritten.
+    for (; next_ < y; ++next_) {
+        if (!decoder_->readRow(out.data())) return decodeFailed();
+    }
+    for (; have < count; ++have, ++next_) {
+        if (!decoder_->readRow(out.data() + have * row)) return decodeFailed();
+    }
+    tail_ = out;
+    tailY_ = y;
+    return true;
+}
+
+// The decoder is left mid-image; the next read starts it over.
+bool StripReader::decodeFailed() {
+    error_ = QString::fromLocal8Bit(decoder_->error());
+    tail_.clear();
+    tailY_ = next_ = height_;
+    return false;
+}
+
+// Header: "P5" width height maxval, separated by whitespace, with '#'
+// comments allowed, then exactly one whitespace byte before the raster.
+bool StripReader::openPgm() {
+    char magic[2];
+    if (file_.read(magic, 2) != 2 || magic[0] != 'P' || magic[1] != '5') return false;
+
+    int fields[3] = { 0, 0, 0 };
+    char c = 0;
+    for (int& field : fields) {
+        for (;;) {
+            if (!file_.getChar(&c)) return false;
+            if (c == '#') {
+                while (c != '\n') {
+                    if (!file_.getChar(&c)) return false;
+                }
+            } else if (!std::isspace(static_cast<unsigned char>(c))) {
+                break;
+            }
+        }
+        if (!std::isdigit(static_cast<unsigned char>(c))) return false;
+        while (std::isdigit(static_cast<unsigned char>(c))) {
+            field = field * 10 + (c - '0');
+            if (!file_.getChar(&c)) return false;
+        }
+    }
+    if (!std::isspace(static_cast<unsigned char>(c))) return false;
+
+    width_ = fields[0];
+    height_ = fields[1];
+    pgmMax_ = fields[2];
+    data_ = file_.pos();
+    return width_ > 0 && height_ > 0 && pgmMax_ > 0 && pgmMax_ < 65536;
+}
+
+bool StripReader::readPgmRows(int y, int count, std::vector<uint8_t>& out) {
+    const qint64 sampleBytes = pgmMax_ > 255 ? 2 : 1;
+    const qint64 rowBytes = sampleBytes * width_;
+    const size_t pixels = static_cast<size_t>(width_) * count;
+    out.resize(pixels);
+    if (!file_.seek(data_ + rowBytes * y)) return false;
+
+    if (sampleBytes == 1 && pgmMax_ == 255) {
+        return file_.read(reinterpret_cast<char*>(out.data()), rowBytes * count) == rowBytes * count;
+    }
+
+    // Rescale to 0..255 a row at a time.
+    std::vector<uint8_t> raw(static_cast<size_t>(rowBytes));
+    for (int r = 0; r < count; ++r) {
+        if (file_.read(reinterpret_cast<char*>(raw.data()), rowBytes) != rowBytes) return false;
+        uint8_t* dst = out.data() + static_cast<size_t>(r) * width_;
+        for (int x = 0; x < width_; ++x) {
+            unsigned v = sampleBytes == 2 ? (raw[2 * x] << 8) | raw[2 * x + 1] : raw[x];
+            dst[x] = static_cast<uint8_t>(std::min(v, static_cast<unsigned>(pgmMax_)) * 255u / pgmMax_);
+        }
+    }
+    return true;
+}
+
+// File header, then a BITMAPINFOHEADER or a later version of it (V4, V5):
+// only uncompressed rows, or 32-bit ones with channel masks, can be read
+// by seeking; run-length encoded and embedded PNG or JPEG bitmaps cannot.
+bool StripReader::openBmp() {
+    uint8_t header[70] = {};
+    qint64 got = file_.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (got < 54) return false;
+    uint32_t infoSize = little(header + 14, 4);
+    if (infoSize < 40) {
+        error_ = "OS/2 BMP headers are not supported";
+        return false;
+    }
+    int32_t width = static_cast<int32_t>(little(header + 18, 4));
+    int32_t height = static_cast<int32_t>(little(header + 22, 4));
+    int bits = static_cast<int>(little(header + 28, 2));
+    uint32_t compression = little(header + 30, 4);
+    uint32_t colors = little(header + 46, 4);
+
+    bool masked = compression == 3 && bits == 32;
+    if (compression != 0 && !masked) {
+        error_ = "compressed BMP cannot be read in strips; save it uncompressed";
+        return false;
+    }
+    if (bits != 1 && bits != 4 && bits != 8 && bits != 24 && bits != 32) {
+        error_ = QString("%1-bit BMP is not supported").arg(bits);
+        return false;
+    }
+    if (masked) {
+        // After a 40-byte header the masks follow it; V4 and V5 hold them.
+        if (got < 66) return false;
+        for (int i = 0; i < 3; ++i) bmpMasks_[i] = little(header + 54 + 4 * i, 4);
+    } else {
+        bmpMasks_[0] = 0x00ff0000;
+        bmpMasks_[1] = 0x0000ff00;
+        bmpMasks_[2] = 0x000000ff;
+    }
+
+    bmpGray_.clear();
+    if (bits <= 8) {
+        size_t entries = colors ? std::min<uint32_t>(colors, 1u << bits) : 1u << bits;
+        std::vector<uint8_t> palette(entries * 4);
+        if (!file_.seek(14 + infoSize)) return false;
+        if (file_.read(reinterpret_cast<char*>(palette.data()), palette.size()) != static_cast<qint64>(palette.size()))
+            return false;
+        bmpGray_.assign(size_t(1) << bits, 0);
+        for (size_t i = 0; i < entries; ++i) bmpGray_[i] = grayOf(palette[4 * i + 2], palette[4 * i + 1], palette[4 * i]);
+    }
+
+    width_ = width;
+    height_ = height < 0 ? -height : height;
+    bmpBottomUp_ = height > 0;
+    bmpBits_ = bits;
+    bmpStride_ = (static_cast<qint64>(width) * bits + 31) / 32 * 4;
+    data_ = little(header + 10, 4);
+    isBmp_ = true;
+    return width_ > 0 && height_ > 0;
+}
+
+// Rows are stored bottom up unless the header's height is negative, so a
+// strip is read a row at a time wherever it lies.
+bool StripReader::readBmpRows(int y, int count, std::vector<uint8_t>& out) {
+    out.resize(static_cast<size_t>(width_) * count);
+    std::vector<uint8_t> raw(static_cast<size_t>(bmpStride_));
+    for (int r = 0; r < count; ++r) {
+        int stored = bmpBottomUp_ ? height_ - 1 - (y + r) : y + r;
+        if (!file_.seek(data_ + bmpStride_ * stored)) return false;
+        if (file_.read(reinterpret_cast<char*>(raw.data()), bmpStride_) != bmpStride_) return false;
+        uint8_t* dst = out.data() + static_cast<size_t>(r) * width_;
+        for (int x = 0; x < width_; ++x) {
+            if (bmpBits_ == 24) {
+                const uint8_t* p = raw.data() + 3 * x;
+                dst[x] = grayOf(p[2], p[1], p[0]);
+            } else if (bmpBits_ == 32) {
+                uint32_t pixel = little(raw.data() + 4 * x, 4);
+                dst[x] = grayOf(channel(pixel, bmpMasks_[0]), channel(pixel, bmpMasks_[1]), channel(pixel, bmpMasks_[2]));
+            } else {
+                int perByte = 8 / bmpBits_;
+                int shift = 8 - bmpBits_ * (x % perByte + 1);
+                dst[x] = bmpGray_[(raw[x / perByte] >> shift) & ((1 << bmpBits_) - 1)];
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+// stripreader.h
+// Reads a heightmap a band of rows at a time as 8-bit gray, so images larger
+// than memory can be processed strip by strip
+
+#ifndef STRIPREADER_H
+#define STRIPREADER_H
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class RowDecoder;   // a libpng or libjpeg pass over one image, in stripreader.cpp
+
+// Binary PGM (P5) and uncompressed BMP are read straight from the file at
+// any row. PNG and JPEG go through one libpng or libjpeg decoder that yields
+// rows top to bottom, so only the rows asked for are ever held. Formats that
+// cannot be read that way (other file types, interlaced PNG, progressive
+// JPEG, run-length BMP) are refused by open() with a reason in error(),
+// never decoded whole.
+class StripReader {
+public:
+    StripReader();
+    ~StripReader();
+
+    bool open(const QString& file);
+    QString error() const { return error_; }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+    // Rows [y, y + count) into out, width() bytes per row. Reads are
+    // cheapest in order; going back to rows before the last read restarts
+    // the decoder, except for rows the last read returned.
+    bool readRows(int y, int count, std::vector<uint8_t>& out);
+
+private:
+    bool openPgm();
+    bool openBmp();
+    bool readPgmRows(int y, int count, std::vector<uint8_t>& out);
+    bool readBmpRows(int y, int count, std::vector<uint8_t>& out);
+    bool readDecodedRows(int y, int count, std::vector<uint8_t>& out);
+    bool decodeFailed();
+
+    QString error_;
+    int width_ = 0, height_ = 0;
+    QFile file_;            // PGM or BMP
+    qint64 data_ = 0;       // offset of the first pixel
+    int pgmMax_ = 255;      // maxval; above 255 samples are 16-bit big endian
+    bool isBmp_ = false;
+    int bmpBits_ = 8;       // per pixel: 1, 4 or 8 through the palette, 24 or 32 direct
+    qint64 bmpStride_ = 0;  // bytes per stored row, padded to 4
+    bool bmpBottomUp_ = true;
+    uint32_t bmpMasks_[3] = { 0x00ff0000, 0x0000ff00, 0x000000ff };   // red, green, blue of a 32-bit pixel
+    std::vector<uint8_t> bmpGray_;   // palette entry -> gray
+
+    std::unique_ptr<RowDecoder> decoder_;   // null for PGM and BMP
+    int next_ = 0;                          // next row the decoder yields
+    std::vector<uint8_t> tail_;             // rows [tailY_, next_), the last read
+    int tailY_ = 0;
+};
+
+#endif // STRIPREADER_H
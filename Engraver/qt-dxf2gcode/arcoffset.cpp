@@ -0,0 +1,184 @@
+// arcoffset.cpp
+// Contours are flattened to half the tolerance and Clipper's round joins use
+// the same chord error, so every edge of an offset arc has both ends within
+// tolerance of its circle and its midpoint at most one chord error inside.
+
+#include "arcoffset.h"
+#include "fixedpoint.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+const unsigned offset_threads = 0;          // offsets run one at a time, so Clipper may use every core
+const size_t max_cells_per_circle = 4096;   // bigger circles are tested against every edge
+const double corner_angle = 1e-3;           // radians; smaller turns between segments are tangent
+
+struct Circle {
+    PointD center;
+    double radius;
+};
+
+// Circles bucketed by the grid cells their bounding box covers.
+class CircleGrid {
+public:
+    explicit CircleGrid(double cell) : cell_(cell) {}
+
+    void add(int index, const Circle& c, double margin) {
+        double r = c.radius + margin;
+        int64_t x0 = cellOf(c.center.x - r), x1 = cellOf(c.center.x + r);
+        int64_t y0 = cellOf(c.center.y - r), y1 = cellOf(c.center.y + r);
+        if (size_t((x1 - x0 + 1) * (y1 - y0 + 1)) > max_cells_per_circle) {
+            everywhere_.push_back(index);
+            return;
+        }
+        for (int64_t y = y0; y <= y1; ++y) {
+            for (int64_t x = x0; x <= x1; ++x) cells_[key(x, y)].push_back(index);
+        }
+    }
+
+    template <typename Fn>
+    void forEachNear(const PointD& p, Fn fn) const {
+        auto it = cells_.find(key(cellOf(p.x), cellOf(p.y)));
+        if (it != cells_.end()) {
+            for (int i : it->second) fn(i);
+        }
+        for (int i : everywhere_) fn(i);
+    }
+
+private:
+    int64_t cellOf(double v) const { return static_cast<int64_t>(std::floor(v / cell_)); }
+    static uint64_t key(int64_t x, int64_t y) { return (static_cast<uint64_t>(x) << 32) ^ static_cast<uint32_t>(y); }
+
+    double cell_;
+    std::unordered_map<uint64_t, std::vector<int>> cells_;
+    std::vector<int> everywhere_;
+};
+
+// Direction of travel at the start (or end) of the segment a -> b; an arc
+// leaves its chord by half its sweep.
+double endDirection(const PointD& a, const PointD& b, double bulge, bool at_start) {
+    double chord = std::atan2(b.y - a.y, b.x - a.x);
+    double half = 2.0 * std::atan(bulge);
+    return at_start ? chord - half : chord + half;
+}
+
+double angleBetween(const PointD& center, const PointD& a, const PointD& b) {
+    double ax = a.x - center.x, ay = a.y - center.y;
+    double bx = b.x - center.x, by = b.y - center.y;
+    return std::atan2(ax * by - ay * bx, ax * bx + ay * by);
+}
+
+} // namespace
+
+std::vector<Contour> offsetContours(const std::vector<Contour>& contours, double delta, double tolerance) {
+    double chord = tolerance / 2.0;
+    double reach = std::fabs(delta);
+
+    PathsD flat;
+    for (const auto& c : contours) {
+        if (c.closed) flat.push_back(flattenContour(c, chord));
+    }
+    PathsD offset = toMm(InflatePaths(toUnits(flat), delta * units_per_mm, JoinType::Round, EndType::Polygon, 2.0,
+                                      chord * units_per_mm, offset_threads));
+
+    // Every circle an offset edge can lie on.
+    std::vector<Circle> circles;
+    CircleGrid grid(std::max(4.0 * reach, 1.0));
+    auto addCircle = [&](const PointD& center, double radius) {
+        if (radius <= tolerance) return;
+        circles.push_back({ center, radius });
+        grid.add(static_cast<int>(circles.size() - 1), circles.back(), tolerance);
+    };
+    for (const auto& c : contours) {
+        if (!c.closed) continue;
+        size_t count = c.segmentCount();
+        for (size_t i = 0; i < count; ++i) {
+            // Round joins only appear at corners, not where segments meet
+            // tangentially, as around a circle.
+            size_t prev = (i + count - 1) % count;
+            double in = endDirection(c.points[prev], c.points[i], c.bulge(prev), false);
+            double outDir = endDirection(c.points[i], c.points[(i + 1) % c.points.size()], c.bulge(i), true);
+            if (std::fabs(std::remainder(outDir - in, 2.0 * pi)) > corner_angle) addCircle(c.points[i], reach);
+            if (c.bulge(i) == 0.0) continue;
+            ArcGeometry arc = bulgeArc(c.points[i], c.points[(i + 1) % c.points.size()], c.bulge(i));
+            addCircle(arc.center, arc.radius + reach);
+            addCircle(arc.center, arc.radius - reach);
+        }
+    }
+
+    auto circleOf = [&](const PointD& p, const PointD& q) {
+        int best = -1;
+        double bestError = 2.0 * tolerance;
+        PointD m(0.5 * (p.x + q.x), 0.5 * (p.y + q.y));
+        grid.forEachNear(p, [&](int i) {
+            const Circle& c = circles[i];
+            double dp = std::hypot(p.x - c.center.x, p.y - c.center.y) - c.radius;
+            double dq = std::hypot(q.x - c.center.x, q.y - c.center.y) - c.radius;
+            double dm = std::hypot(m.x - c.center.x, m.y - c.center.y) - c.radius;
+            if (std::fabs(dp) > tolerance || std::fabs(dq) > tolerance) return;
+            if (dm > tolerance || dm < -(chord + tolerance)) return;   // a chord longer than the flattening makes
+            double error = std::fabs(dp) + std::fabs(dq);
+            if (error < bestError) {
+                bestError = error;
+                best = i;
+            }
+        });
+        return best;
+    };
+
+    std::vector<Contour> out;
+    for (const auto& path : offset) {
+        size_t n = path.size();
+        if (n < 3) continue;
+        std::vector<int> on(n);
+        for (size_t k = 0; k < n; ++k) on[k] = circleOf(path[k], path[(k + 1) % n]);
+
+        // Start where a run of arc edges begins, so no arc wraps past the end.
+        size_t start = 0;
+        for (size_t k = 0; k < n; ++k) {
+            if (on[k] < 0 || on[k] != on[(k + n - 1) % n]) {
+                start = k;
+                break;
+            }
+        }
+
+        Contour c;
+        c.closed = true;
+        for (size_t k = 0; k < n;) {
+            size_t i = (start + k) % n;
+            int id = on[i];
+            if (id < 0) {
+                c.points.push_back(path[i]);
+                c.bulges.push_back(0.0);
+                ++k;
+                continue;
+            }
+            const Circle& circle = circles[id];
+            size_t run = 1;
+            double sweep = angleBetween(circle.center, path[i], path[(i + 1) % n]);
+            while (k + run < n && on[(i + run) % n] == id) {
+                sweep += angleBetween(circle.center, path[(i + run) % n], path[(i + run + 1) % n]);
+                ++run;
+            }
+            int pieces = std::max(1, static_cast<int>(std::ceil(std::fabs(sweep) / pi - 1e-9)));
+            if (run == n) pieces = std::max(pieces, 2);   // a whole circle needs two arcs
+            double a0 = std::atan2(path[i].y - circle.center.y, path[i].x - circle.center.x);
+            for (int p = 0; p < pieces; ++p) {
+                double a = a0 + sweep * p / pieces;
+                c.points.push_back(p == 0 ? path[i]
+                                          : PointD(circle.center.x + circle.radius * std::cos(a),
+                                                   circle.center.y + circle.radius * std::sin(a)));
+                c.bulges.push_back(std::tan(sweep / pieces / 4.0));
+            }
+            k += run;
+        }
+        out.push_back(std::move(c));
+    }
+    return out;
+}
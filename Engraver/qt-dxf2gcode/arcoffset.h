@@ -0,0 +1,19 @@
+// arcoffset.h
+// Offsets closed line/arc contours and hands the arcs back as arcs
+
+#ifndef ARCOFFSET_H
+#define ARCOFFSET_H
+
+#include <vector>
+#include "curves.h"
+
+// Clipper does the offset itself, on the contours flattened to tolerance, so
+// overlaps, holes and vanishing pieces are resolved as usual. Each edge of
+// the result is then matched against the circles an offset can produce: a
+// source arc's circle grown or shrunk by delta, and the round join of radius
+// delta about each source vertex. Runs of edges on the same circle come back
+// as one arc with its exact centre, so arcs stay arcs in the G-code instead
+// of hundreds of short lines.
+std::vector<Contour> offsetContours(const std::vector<Contour>& contours, double delta, double tolerance);
+
+#endif // ARCOFFSET_H
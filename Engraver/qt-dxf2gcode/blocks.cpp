@@ -0,0 +1,101 @@
+// blocks.cpp
+// Placements are plain 2D affine maps, so nesting composes them and a
+// conformal one can carry bulges across unchanged except for their sign.
+
+#include "blocks.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+const double conformal_tolerance = 1e-9;   // relative; a looser match would bend arcs off their ends
+
+void expand(const std::vector<BlockInsert>& inserts, const std::map<std::string, Block>& blocks,
+            const Placement& outer, const std::string& outerLayer, int depth, std::vector<BlockInstance>& out) {
+    for (const auto& insert : inserts) {
+        auto it = blocks.find(insert.block);
+        if (it == blocks.end()) continue;
+        std::string layer = insert.layer == "0" && !outerLayer.empty() ? outerLayer : insert.layer;
+        Placement fromBase;
+        fromBase.tx = -it->second.base.x;
+        fromBase.ty = -it->second.base.y;
+        Placement placement = fromBase.then(insert.placement).then(outer);
+        for (const auto& entry : it->second.layerContours) {
+            if (entry.second.empty()) continue;
+            out.push_back({ insert.block, entry.first, entry.first == "0" ? layer : entry.first, placement });
+        }
+        if (depth > 0) expand(it->second.inserts, blocks, placement, layer, depth - 1, out);
+    }
+}
+
+} // namespace
+
+Placement Placement::then(const Placement& outer) const {
+    Placement p;
+    p.a = outer.a * a + outer.b * c;
+    p.b = outer.a * b + outer.b * d;
+    p.c = outer.c * a + outer.d * c;
+    p.d = outer.c * b + outer.d * d;
+    p.tx = outer.a * tx + outer.b * ty + outer.tx;
+    p.ty = outer.c * tx + outer.d * ty + outer.ty;
+    return p;
+}
+
+bool Placement::conformal() const {
+    double size = std::fabs(a) + std::fabs(b) + std::fabs(c) + std::fabs(d);
+    double eps = conformal_tolerance * size;
+    if (size == 0.0) return false;
+    if (mirrored()) return std::fabs(a + d) <= eps && std::fabs(b - c) <= eps;
+    return std::fabs(a - d) <= eps && std::fabs(b + c) <= eps;
+}
+
+double Placement::scale() const {
+    return std::sqrt(std::fabs(a * d - b * c));
+}
+
+bool Placement::mirrored() const {
+    return a * d - b * c < 0.0;
+}
+
+Placement insertPlacement(const PointD& at, double xscale, double yscale, double angle) {
+    double cs = std::cos(angle), sn = std::sin(angle);
+    Placement p;
+    p.a = cs * xscale;
+    p.b = -sn * yscale;
+    p.c = sn * xscale;
+    p.d = cs * yscale;
+    p.tx = at.x;
+    p.ty = at.y;
+    return p;
+}
+
+Contour placeContour(const Contour& contour, const Placement& placement, double tolerance) {
+    Contour out;
+    out.closed = contour.closed;
+    if (placement.conformal()) {
+        out.points.reserve(contour.points.size());
+        for (const auto& p : contour.points) out.points.push_back(placement.apply(p));
+        out.bulges = contour.bulges;
+        if (placement.mirrored()) {
+            for (double& bulge : out.bulges) bulge = -bulge;
+        }
+        return out;
+    }
+    // Circles become ellipses: flatten finely enough that the stretch
+    // still leaves every chord within tolerance.
+    double stretch = std::sqrt(placement.a * placement.a + placement.b * placement.b + placement.c * placement.c +
+                               placement.d * placement.d);
+    for (const auto& p : flattenContour(contour, tolerance / std::max(stretch, 1e-9))) {
+        out.points.push_back(placement.apply(p));
+    }
+    return out;
+}
+
+std::vector<BlockInstance> expandInserts(const std::vector<BlockInsert>& inserts,
+                                         const std::map<std::string, Block>& blocks, int max_depth) {
+    std::vector<BlockInstance> out;
+    expand(inserts, blocks, Placement(), std::string(), max_depth, out);
+    return out;
+}
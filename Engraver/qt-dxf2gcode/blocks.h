@@ -0,0 +1,66 @@
+// blocks.h
+// DXF block definitions kept as geometry of their own, and the INSERTs that place them
+
+#ifndef BLOCKS_H
+#define BLOCKS_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "clipper2/clipper.h"
+#include "curves.h"
+
+// p' = (a b; c d) p + (tx, ty)
+struct Placement {
+    double a = 1.0, b = 0.0, c = 0.0, d = 1.0;
+    double tx = 0.0, ty = 0.0;
+
+    Clipper2Lib::PointD apply(const Clipper2Lib::PointD& p) const {
+        return Clipper2Lib::PointD(a * p.x + b * p.y + tx, c * p.x + d * p.y + ty);
+    }
+    // This placement, then outer.
+    Placement then(const Placement& outer) const;
+    // Rotation and uniform scale, possibly mirrored: circles stay circles.
+    bool conformal() const;
+    double scale() const;    // the uniform scale of a conformal placement
+    bool mirrored() const;
+};
+
+// An INSERT: scaled and rotated about the block's base point, which is
+// moved to at. The base point itself is applied by expandInserts, since a
+// nested insert can come before the block it names.
+Placement insertPlacement(const Clipper2Lib::PointD& at, double xscale, double yscale, double angle);
+
+// The contour under a placement. Conformal placements keep arcs as arcs
+// (mirrored ones turn the other way); any other flattens them to tolerance.
+Contour placeContour(const Contour& contour, const Placement& placement, double tolerance);
+
+struct BlockInsert {
+    std::string block;
+    std::string layer;
+    Placement placement;
+};
+
+struct Block {
+    Clipper2Lib::PointD base;
+    std::map<std::string, std::vector<Contour>> layerPieces;     // entities as read
+    std::map<std::string, std::vector<Contour>> layerContours;   // chained after the read
+    std::vector<BlockInsert> inserts;                             // blocks nested in this one
+};
+
+// One placed copy of the contours a block has on one of its layers.
+struct BlockInstance {
+    std::string block;
+    std::string blockLayer;   // where the contours are in the block
+    std::string layer;        // the layer they are cut under
+    Placement placement;
+};
+
+// Every instance the inserts put down, through nested blocks. Block
+// entities on layer "0" take the layer of the insert that places them, as
+// they do in CAD. Inserts of missing blocks, and nesting deeper than
+// max_depth (a block that inserts itself), are dropped.
+std::vector<BlockInstance> expandInserts(const std::vector<BlockInsert>& inserts,
+                                         const std::map<std::string, Block>& blocks, int max_depth = 16);
+
+#endif // BLOCKS_H
@@ -0,0 +1,165 @@
+// contourchain.cpp
+// Joined endpoints take the position of the first endpoint seen at the node,
+// so a chain that comes back to its start closes exactly.
+
+#include "contourchain.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+// Points bucketed by grid cell; a query within one cell size only has to
+// look at the 3x3 cells around the point.
+class PointGrid {
+public:
+    explicit PointGrid(double cell) : cell_(cell > 0.0 ? cell : 1e-9) {}
+
+    // Index of the nearest stored point within radius (<= cell), or -1.
+    long nearest(const PointD& p, double radius, const std::vector<PointD>& points, long skip = -1) const {
+        long best = -1;
+        double bestD = radius * radius;
+        int64_t cx = cellOf(p.x), cy = cellOf(p.y);
+        for (int64_t dy = -1; dy <= 1; ++dy) {
+            for (int64_t dx = -1; dx <= 1; ++dx) {
+                auto it = cells_.find(key(cx + dx, cy + dy));
+                if (it == cells_.end()) continue;
+                for (long i : it->second) {
+                    if (i == skip) continue;
+                    double ex = points[i].x - p.x, ey = points[i].y - p.y;
+                    double d = ex * ex + ey * ey;
+                    if (d <= bestD) {
+                        bestD = d;
+                        best = i;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    void insert(const PointD& p, long index) { cells_[key(cellOf(p.x), cellOf(p.y))].push_back(index); }
+
+private:
+    int64_t cellOf(double v) const { return static_cast<int64_t>(std::floor(v / cell_)); }
+    static uint64_t key(int64_t x, int64_t y) { return (static_cast<uint64_t>(x) << 32) ^ static_cast<uint32_t>(y); }
+
+    double cell_;
+    std::unordered_map<uint64_t, std::vector<long>> cells_;
+};
+
+struct PieceEnd {
+    size_t piece;
+    int side;   // 0: the piece starts here, 1: it ends here
+};
+
+} // namespace
+
+std::vector<Contour> chainContours(const std::vector<Contour>& pieces, double weld_tolerance, double gap_distance,
+                                   ChainReport* report) {
+    std::vector<Contour> contours;
+    // Weld the endpoints into nodes.
+    std::vector<PointD> nodes;
+    std::vector<std::vector<PieceEnd>> ends;
+    std::vector<long> pieceNode(pieces.size() * 2, -1);
+    PointGrid grid(weld_tolerance);
+    auto nodeOf = [&](const PointD& p) {
+        long n = grid.nearest(p, weld_tolerance, nodes);
+        if (n < 0) {
+            n = static_cast<long>(nodes.size());
+            nodes.push_back(p);
+            ends.emplace_back();
+            grid.insert(p, n);
+        }
+        return n;
+    };
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        if (pieces[i].closed) {
+            contours.push_back(pieces[i]);
+            continue;
+        }
+        const PathD& piece = pieces[i].points;
+        if (piece.size() < 2) continue;
+        long a = nodeOf(piece.front());
+        long b = nodeOf(piece.back());
+        bool straight = std::all_of(pieces[i].bulges.begin(), pieces[i].bulges.end(), [](double b) { return b == 0.0; });
+        if (a == b && piece.size() < 4 && straight) continue;   // shorter than the tolerance, or a loop with no area
+        pieceNode[2 * i] = a;
+        pieceNode[2 * i + 1] = b;
+        ends[a].push_back({ i, 0 });
+        ends[b].push_back({ i, 1 });
+    }
+
+    std::vector<bool> used(pieces.size(), false);
+    std::vector<long> freeEnds;   // nodes where an open contour stops with nothing else attached
+    auto walk = [&](long start, PieceEnd e) {
+        Contour c;
+        c.points.push_back(nodes[start]);
+        for (;;) {
+            used[e.piece] = true;
+            const Contour& piece = pieces[e.piece];
+            size_t last = piece.points.size() - 1;
+            long next = pieceNode[2 * e.piece + 1 - e.side];
+            for (size_t k = 0; k < last; ++k) {
+                if (e.side == 0) {
+                    c.bulges.push_back(piece.bulge(k));
+                    c.points.push_back(k + 1 < last ? piece.points[k + 1] : nodes[next]);
+                } else {
+                    c.bulges.push_back(-piece.bulge(last - 1 - k));
+                    c.points.push_back(k + 1 < last ? piece.points[last - 1 - k] : nodes[next]);
+                }
+            }
+            if (next == start) {
+                c.closed = true;
+                c.points.pop_back();
+                break;
+            }
+            if (ends[next].size() != 2) break;
+            const PieceEnd& other = ends[next][0].piece == e.piece ? ends[next][1] : ends[next][0];
+            if (used[other.piece]) break;
+            e = other;
+        }
+        if (c.closed ? c.points.size() < 3 : c.points.size() < 2) return;
+        if (!c.closed) {
+            if (ends[start].size() == 1) freeEnds.push_back(start);
+            long last = pieceNode[2 * e.piece + 1 - e.side];
+            if (ends[last].size() == 1) freeEnds.push_back(last);
+        }
+        contours.push_back(std::move(c));
+    };
+
+    // Open chains and branches first, from every node that is not a plain
+    // pass-through; whatever is left over is made of closed loops.
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        if (ends[n].size() == 2) continue;
+        for (const PieceEnd& e : ends[n]) {
+            if (!used[e.piece]) walk(static_cast<long>(n), e);
+        }
+    }
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        if (!used[i] && pieceNode[2 * i] >= 0 && !pieces[i].closed) walk(pieceNode[2 * i], { i, 0 });
+    }
+
+    if (report) {
+        *report = ChainReport();
+        for (const Contour& c : contours) ++(c.closed ? report->closed : report->open);
+        // Ends at branches are joined to something; only free ends can be
+        // gaps. Each free end's nearest other open end, each pair reported once.
+        std::vector<PointD> openEnds;
+        for (long n : freeEnds) openEnds.push_back(nodes[n]);
+        PointGrid endGrid(gap_distance);
+        for (size_t i = 0; i < openEnds.size(); ++i) endGrid.insert(openEnds[i], static_cast<long>(i));
+        for (size_t i = 0; i < openEnds.size(); ++i) {
+            long j = endGrid.nearest(openEnds[i], gap_distance, openEnds, static_cast<long>(i));
+            if (j < 0) continue;
+            long back = endGrid.nearest(openEnds[j], gap_distance, openEnds, j);
+            if (back == static_cast<long>(i) && j < static_cast<long>(i)) continue;   // already reported from j
+            double dx = openEnds[j].x - openEnds[i].x, dy = openEnds[j].y - openEnds[i].y;
+            report->gaps.push_back({ openEnds[i], openEnds[j], std::sqrt(dx * dx + dy * dy) });
+        }
+    }
+    return contours;
+}
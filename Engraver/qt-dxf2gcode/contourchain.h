@@ -0,0 +1,33 @@
+// contourchain.h
+// Joins loose DXF entities end to end into closed and open contours
+
+#ifndef CONTOURCHAIN_H
+#define CONTOURCHAIN_H
+
+#include <vector>
+#include "clipper2/clipper.h"
+#include "curves.h"
+
+// Two open contour ends that are further apart than the weld tolerance but
+// close enough that they were most likely meant to meet.
+struct ChainGap {
+    Clipper2Lib::PointD a, b;
+    double distance = 0.0;
+};
+
+struct ChainReport {
+    size_t closed = 0;
+    size_t open = 0;
+    std::vector<ChainGap> gaps;
+};
+
+// Endpoints within weld_tolerance of each other become one node, found
+// through a grid hash with cells of that size, so the whole pass is linear
+// in the number of entities. Chains run through nodes where exactly two
+// pieces meet and stop at free ends and branches; a piece walked backwards
+// has its bulges reversed. Closed pieces pass straight through. Open ends
+// closer than gap_distance to another open end are reported as gaps.
+std::vector<Contour> chainContours(const std::vector<Contour>& pieces, double weld_tolerance,
+                                   double gap_distance, ChainReport* report = nullptr);
+
+#endif // CONTOURCHAIN_H
@@ -0,0 +1,194 @@
+// curves.cpp
+// Flattening subdivides until the curve's midpoint and quarter points all lie
+// within tolerance of the chord, starting from a few pieces per knot span so
+// that no wiggle falls between samples.
+
+#include "curves.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+const int max_flatten_depth = 16;
+
+double distance(const PointD& a, const PointD& b) {
+    return std::hypot(b.x - a.x, b.y - a.y);
+}
+
+double distanceToChord(const PointD& p, const PointD& a, const PointD& b) {
+    double dx = b.x - a.x, dy = b.y - a.y;
+    double len = std::hypot(dx, dy);
+    if (len <= 0.0) return distance(p, a);
+    return std::fabs((p.x - a.x) * dy - (p.y - a.y) * dx) / len;
+}
+
+// Appends the points after f(t0) up to and including p1 = f(t1).
+template <typename Curve>
+void flattenSpan(const Curve& f, double t0, const PointD& p0, double t1, const PointD& p1, double tolerance, int depth,
+                 PathD& out) {
+    double tm = 0.5 * (t0 + t1);
+    PointD pm = f(tm);
+    if (depth < max_flatten_depth &&
+        (distanceToChord(pm, p0, p1) > tolerance || distanceToChord(f(0.5 * (t0 + tm)), p0, p1) > tolerance ||
+         distanceToChord(f(0.5 * (tm + t1)), p0, p1) > tolerance)) {
+        flattenSpan(f, t0, p0, tm, pm, tolerance, depth + 1, out);
+        flattenSpan(f, tm, pm, t1, p1, tolerance, depth + 1, out);
+    } else {
+        out.push_back(p1);
+    }
+}
+
+template <typename Curve>
+void flattenRange(const Curve& f, double t0, double t1, int pieces, double tolerance, PathD& out) {
+    PointD prev = f(t0);
+    for (int i = 1; i <= pieces; ++i) {
+        double t = t0 + (t1 - t0) * i / pieces;
+        PointD p = f(t);
+        flattenSpan(f, t0 + (t1 - t0) * (i - 1) / pieces, prev, t, p, tolerance, 0, out);
+        prev = p;
+    }
+}
+
+// A flattened curve whose ends meet becomes a closed contour.
+Contour polylineContour(PathD points, double tolerance) {
+    Contour c;
+    if (points.size() > 2 && distance(points.front(), points.back()) <= tolerance) {
+        points.pop_back();
+        c.closed = true;
+    }
+    c.points = std::move(points);
+    return c;
+}
+
+} // namespace
+
+ArcGeometry bulgeArc(const PointD& a, const PointD& b, double bulge) {
+    ArcGeometry arc;
+    double len = distance(a, b);
+    double sagitta = bulge * len / 2.0;                        // signed, like the bulge
+    double radius = (len * len / 4.0 + sagitta * sagitta) / (2.0 * sagitta);
+    PointD left(-(b.y - a.y) / len, (b.x - a.x) / len);
+    PointD mid(0.5 * (a.x + b.x), 0.5 * (a.y + b.y));
+    arc.center = PointD(mid.x + left.x * (radius - sagitta), mid.y + left.y * (radius - sagitta));
+    arc.radius = std::fabs(radius);
+    arc.start = std::atan2(a.y - arc.center.y, a.x - arc.center.x);
+    arc.sweep = 4.0 * std::atan(bulge);
+    return arc;
+}
+
+Contour arcContour(const PointD& center, double radius, double start, double sweep) {
+    Contour c;
+    int pieces = std::max(1, static_cast<int>(std::ceil(std::fabs(sweep) / pi - 1e-9)));
+    double step = sweep / pieces;
+    for (int i = 0; i <= pieces; ++i) {
+        double a = start + step * i;
+        c.points.push_back(PointD(center.x + radius * std::cos(a), center.y + radius * std::sin(a)));
+        if (i < pieces) c.bulges.push_back(std::tan(step / 4.0));
+    }
+    return c;
+}
+
+Contour circleContour(const PointD& center, double radius) {
+    Contour c;
+    c.points = { PointD(center.x + radius, center.y), PointD(center.x - radius, center.y) };
+    c.bulges = { 1.0, 1.0 };
+    c.closed = true;
+    return c;
+}
+
+Contour ellipseContour(const PointD& center, const PointD& major_axis, double ratio, double start_param,
+                       double end_param, double tolerance) {
+    double sweep = end_param - start_param;
+    while (sweep <= 0.0) sweep += 2.0 * pi;
+    while (sweep > 2.0 * pi + 1e-9) sweep -= 2.0 * pi;
+    bool full = sweep > 2.0 * pi - 1e-9;
+
+    double major = std::hypot(major_axis.x, major_axis.y);
+    double rotation = std::atan2(major_axis.y, major_axis.x);
+    if (std::fabs(ratio - 1.0) < 1e-9) {
+        if (!full) return arcContour(center, major, rotation + start_param, sweep);
+        Contour c = circleContour(center, major);
+        for (auto& p : c.points) {   // start at the major axis, as the DXF has it
+            double x = p.x - center.x, y = p.y - center.y;
+            p = PointD(center.x + x * std::cos(rotation) - y * std::sin(rotation),
+                       center.y + x * std::sin(rotation) + y * std::cos(rotation));
+        }
+        return c;
+    }
+
+    PointD minor(-major_axis.y * ratio, major_axis.x * ratio);
+    auto at = [&](double t) {
+        return PointD(center.x + major_axis.x * std::cos(t) + minor.x * std::sin(t),
+                      center.y + major_axis.y * std::cos(t) + minor.y * std::sin(t));
+    };
+    PathD points{ at(start_param) };
+    flattenRange(at, start_param, start_param + sweep, std::max(2, static_cast<int>(std::ceil(sweep / (pi / 8)))),
+                 tolerance, points);
+    return polylineContour(std::move(points), full ? tolerance : 0.0);
+}
+
+Contour splineContour(const std::vector<PointD>& control, const std::vector<double>& weights,
+                      const std::vector<double>& knots, int degree, double tolerance) {
+    size_t n = control.size();
+    if (degree < 1 || n <= size_t(degree) || knots.size() != n + degree + 1) {
+        return polylineContour(PathD(control.begin(), control.end()), tolerance);   // not a valid spline; keep the hull
+    }
+    bool rational = weights.size() == n;
+
+    // de Boor's algorithm in homogeneous coordinates.
+    auto at = [&](double u) {
+        size_t span = size_t(degree);
+        while (span + 1 < n && knots[span + 1] <= u) ++span;
+        std::vector<double> x(degree + 1), y(degree + 1), w(degree + 1);
+        for (int j = 0; j <= degree; ++j) {
+            size_t i = span - degree + j;
+            double wi = rational ? weights[i] : 1.0;
+            x[j] = control[i].x * wi;
+            y[j] = control[i].y * wi;
+            w[j] = wi;
+        }
+        for (int r = 1; r <= degree; ++r) {
+            for (int j = degree; j >= r; --j) {
+                size_t i = span - degree + j;
+                double denom = knots[i + degree - r + 1] - knots[i];
+                double alpha = denom > 0.0 ? (u - knots[i]) / denom : 0.0;
+                x[j] = (1.0 - alpha) * x[j - 1] + alpha * x[j];
+                y[j] = (1.0 - alpha) * y[j - 1] + alpha * y[j];
+                w[j] = (1.0 - alpha) * w[j - 1] + alpha * w[j];
+            }
+        }
+        return PointD(x[degree] / w[degree], y[degree] / w[degree]);
+    };
+
+    PathD points{ at(knots[degree]) };
+    for (size_t k = size_t(degree); k < n; ++k) {
+        if (knots[k + 1] > knots[k]) flattenRange(at, knots[k], knots[k + 1], 4, tolerance, points);
+    }
+    return polylineContour(std::move(points), tolerance);
+}
+
+PathD flattenContour(const Contour& contour, double tolerance) {
+    PathD out;
+    if (contour.points.empty()) return out;
+    out.push_back(contour.points[0]);
+    for (size_t i = 0; i < contour.segmentCount(); ++i) {
+        const PointD& a = contour.points[i];
+        const PointD& b = contour.points[(i + 1) % contour.points.size()];
+        bool last = contour.closed && i + 1 == contour.segmentCount();
+        double bulge = contour.bulge(i);
+        if (bulge != 0.0) {
+            ArcGeometry arc = bulgeArc(a, b, bulge);
+            double stepAngle = arc.radius > tolerance ? 2.0 * std::acos(1.0 - tolerance / arc.radius) : pi / 2.0;
+            int steps = std::max(1, static_cast<int>(std::ceil(std::fabs(arc.sweep) / stepAngle)));
+            for (int s = 1; s < steps; ++s) {
+                double t = arc.start + arc.sweep * s / steps;
+                out.push_back(PointD(arc.center.x + arc.radius * std::cos(t), arc.center.y + arc.radius * std::sin(t)));
+            }
+        }
+        if (!last) out.push_back(b);
+    }
+    return out;
+}
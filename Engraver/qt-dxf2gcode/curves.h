@@ -0,0 +1,51 @@
+// curves.h
+// Contours of lines and arcs (DXF bulges), and the DXF curves that feed them
+
+#ifndef CURVES_H
+#define CURVES_H
+
+#include <vector>
+#include "clipper2/clipper.h"
+
+// bulges[i] belongs to the segment from points[i] to the next point: 0 for a
+// straight line, tan(sweep / 4) for an arc, positive counter-clockwise (the
+// DXF convention). Closed contours have one bulge per point, the last for
+// the closing segment; open ones one fewer. No bulges at all means all lines.
+struct Contour {
+    Clipper2Lib::PathD points;   // a closed contour does not repeat its first point
+    std::vector<double> bulges;
+    bool closed = false;
+
+    size_t segmentCount() const { return points.empty() ? 0 : (closed ? points.size() : points.size() - 1); }
+    double bulge(size_t segment) const { return segment < bulges.size() ? bulges[segment] : 0.0; }
+};
+
+struct ArcGeometry {
+    Clipper2Lib::PointD center;
+    double radius = 0.0;
+    double start = 0.0;   // angle of the first point
+    double sweep = 0.0;   // signed, counter-clockwise positive
+};
+
+// The arc through a and b with the given (non-zero) bulge.
+ArcGeometry bulgeArc(const Clipper2Lib::PointD& a, const Clipper2Lib::PointD& b, double bulge);
+
+// The arc of a circle from angle start, sweeping sweep radians, split into
+// segments of at most 180 degrees.
+Contour arcContour(const Clipper2Lib::PointD& center, double radius, double start, double sweep);
+Contour circleContour(const Clipper2Lib::PointD& center, double radius);
+
+// Curves that are not arcs, flattened so no chord strays more than
+// tolerance from the curve. Arcs come back as arcs when ratio is 1.
+Contour ellipseContour(const Clipper2Lib::PointD& center, const Clipper2Lib::PointD& major_axis, double ratio,
+                       double start_param, double end_param, double tolerance);
+
+// A NURBS curve (weights may be empty) of the given degree over the knots.
+Contour splineContour(const std::vector<Clipper2Lib::PointD>& control, const std::vector<double>& weights,
+                      const std::vector<double>& knots, int degree, double tolerance);
+
+// All segments as lines; arcs are split into chords within tolerance. The
+// closing segment of a closed contour is left implicit.
+Clipper2Lib::PathD flattenContour(const Contour& contour, double tolerance);
+
+#endif // CURVES_H
@@ -0,0 +1,95 @@
+// jobplanner.cpp
+// The search keeps, for each tool a phase can end on, the fewest changes
+// needed to get there; a phase of n tools costs n - 1 changes inside it plus
+// one more if it cannot start on the tool the previous phase ended with.
+
+#include "jobplanner.h"
+#include <limits>
+#include <map>
+
+namespace {
+
+const int phase_count = 3;
+const size_t unreachable = std::numeric_limits<size_t>::max();
+
+struct Step {
+    size_t changes = unreachable;
+    int first = -1;      // tool the phase starts with
+    int previous = -1;   // tool the phase before ended with
+};
+
+} // namespace
+
+std::vector<PlannedOperation> planOperations(const std::vector<std::string>& layers, const ToolLibrary& library) {
+    // phase -> tool -> layers
+    std::map<int, std::vector<std::string>> byTool[phase_count];
+    std::map<std::string, LayerRule> rules;
+    for (const auto& layer : layers) {
+        LayerRule rule = library.ruleFor(layer);
+        if (!library.tool(rule.tool)) continue;
+        rules[layer] = rule;
+        byTool[static_cast<int>(rule.operation)][rule.tool].push_back(layer);
+    }
+
+    std::vector<int> phases;
+    for (int p = 0; p < phase_count; ++p) {
+        if (!byTool[p].empty()) phases.push_back(p);
+    }
+    if (phases.empty()) return {};
+
+    // steps[k][last]: the cheapest way through phase k ending on tool last.
+    std::vector<std::map<int, Step>> steps(phases.size());
+    for (size_t k = 0; k < phases.size(); ++k) {
+        const auto& tools = byTool[phases[k]];
+        size_t inside = tools.size() - 1;
+        for (const auto& [first, firstLayers] : tools) {
+            for (const auto& [last, lastLayers] : tools) {
+                if (tools.size() > 1 && first == last) continue;
+                if (k == 0) {
+                    Step& s = steps[k][last];
+                    if (inside < s.changes) s = { inside, first, -1 };
+                    continue;
+                }
+                for (const auto& [previous, before] : steps[k - 1]) {
+                    size_t changes = before.changes + inside + (previous == first ? 0 : 1);
+                    Step& s = steps[k][last];
+                    if (changes < s.changes) s = { changes, first, previous };
+                }
+            }
+        }
+    }
+
+    // Walk back from the cheapest end for each phase's first and last tool.
+    std::vector<std::pair<int, int>> ends(phases.size());
+    int last = -1;
+    for (const auto& [tool, s] : steps.back()) {
+        if (last < 0 || s.changes < steps.back()[last].changes) last = tool;
+    }
+    for (size_t k = phases.size(); k-- > 0;) {
+        const Step& s = steps[k][last];
+        ends[k] = { s.first, last };
+        last = s.previous;
+    }
+
+    std::vector<PlannedOperation> plan;
+    for (size_t k = 0; k < phases.size(); ++k) {
+        const auto& tools = byTool[phases[k]];
+        std::vector<int> order = { ends[k].first };
+        for (const auto& entry : tools) {
+            if (entry.first != ends[k].first && entry.first != ends[k].second) order.push_back(entry.first);
+        }
+        if (ends[k].second != ends[k].first) order.push_back(ends[k].second);
+        for (int tool : order) {
+            for (const auto& layer : tools.at(tool)) plan.push_back({ layer, rules[layer] });
+        }
+    }
+    return plan;
+}
+
+size_t toolLoads(const std::vector<PlannedOperation>& plan) {
+    size_t loads = 0;
+    for (size_t i = 0; i < plan.size(); ++i) {
+        if (i == 0 || plan[i].rule.tool != plan[i - 1].rule.tool) ++loads;
+    }
+    return loads;
+}
@@ -0,0 +1,27 @@
+// jobplanner.h
+// Orders a sheet's layer operations to keep tool changes down
+
+#ifndef JOBPLANNER_H
+#define JOBPLANNER_H
+
+#include <string>
+#include <vector>
+#include "toollibrary.h"
+
+struct PlannedOperation {
+    std::string layer;
+    LayerRule rule;   // operation, tool and depth for the layer
+};
+
+// All engraving comes before any pocket and all pockets before any profile.
+// Within each of those phases the operations are grouped by tool, and the
+// order of the groups is chosen so that, where it can, the tool that ends
+// one phase starts the next. With three phases that is a small search over
+// the first and last tool of each, which finds the fewest changes exactly.
+// Layers whose tool is not in the library are left out.
+std::vector<PlannedOperation> planOperations(const std::vector<std::string>& layers, const ToolLibrary& library);
+
+// Tool loads the plan needs, the first one included.
+size_t toolLoads(const std::vector<PlannedOperation>& plan);
+
+#endif // JOBPLANNER_H
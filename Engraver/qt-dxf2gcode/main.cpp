@@ -8,7 +8,22 @@
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QDebug>
+#include <QPolygonF>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <set>
+#include <tuple>
 #include "clipper2/clipper.h"
+#include "arcoffset.h"
+#include "blocks.h"
+#include "contourchain.h"
+#include "curves.h"
+#include "fixedpoint.h"
+#include "jobplanner.h"
+#include "nesting.h"
+#include "passplan.h"
+#include "previewcache.h"
+#include "toollibrary.h"
 #include "drw_interface.h"
 #include "libdxfrw.h"
 
@@ -18,21 +33,33 @@
 
 using namespace Clipper2Lib;
 
-enum ToolType { FlatEnd, TSlot, VBit };
-
-struct Tool {
-    ToolType type;
-    double diameter;
-    double depth_per_pass;
-    double total_depth;
-    double v_angle_deg; // Only for VBit
-};
+const double weld_tolerance = 0.01;       // mm; entity endpoints closer than this are joined
+const double gap_report_distance = 0.5;   // mm; open ends closer than this are reported as gaps
+const double curve_tolerance = 0.005;     // mm; chord error where ellipses and splines have to be flattened
+const double zoom_step = 1.15;            // per wheel notch
+const double sheet_width = 600.0;         // mm; stock the nest lays parts out on
+const double sheet_height = 400.0;        // mm
+const double nest_margin = 2.0;           // mm left between cuts on top of the widest tool
+const double nest_time_limit = 5.0;       // seconds spent improving the nest
 
 class DXFViewer : public QWidget, public DRW_Interface {
 public:
-    std::vector<QPointF> polyline;
-    std::map<std::string, std::vector<PathD>> layerPaths;
-    Tool currentTool = { TSlot, 6.0, 1.5, 4.5, 60.0 }; // Default tool
+    std::map<std::string, std::vector<Contour>> layerPieces;    // entities as read
+    std::map<std::string, std::vector<Contour>> layerContours;  // chained per layer after the read
+    std::vector<ChainGap> gaps;
+    std::map<std::string, Block> blocks;
+    std::vector<BlockInsert> inserts;                                  // model space inserts as read
+    std::map<std::string, std::vector<BlockInstance>> layerInstances;  // expanded per layer they are cut under
+    Block* currentBlock = nullptr;                                     // where entities go during the read
+    // Toolpaths of a block's layer per offset in block units, so each part
+    // is offset once however many times it is placed.
+    std::map<std::tuple<std::string, std::string, double>, std::vector<Contour>> blockToolpaths;
+    ToolLibrary toolLibrary = defaultToolLibrary();
+    PreviewCache drawingPreview{ Qt::green, Qt::yellow };
+    PreviewCache toolpathPreview{ Qt::cyan, Qt::cyan };   // from the last export, over the drawing
+    double viewScale = 1.0;                               // pixels per mm
+    PointD viewCenter{ 0, 0 };                            // mm, at the middle of the widget
+    QPoint lastMouse;
 
     void addHeader(const DRW_Header*) override {}
     void addLType(const DRW_LType&) override {}
@@ -41,19 +68,11 @@ public:
     void addVport(const DRW_Vport&) override {}
     void addTextStyle(const DRW_Textstyle&) override {}
     void addAppId(const DRW_AppId&) override {}
-    void addBlock(const DRW_Block&) override {}
     void setBlock(const int) override {}
-    void endBlock() override {}
     void addPoint(const DRW_Point&) override {}
     void addRay(const DRW_Ray&) override {}
     void addXline(const DRW_Xline&) override {}
-    void addArc(const DRW_Arc&) override {}
-    void addCircle(const DRW_Circle&) override {}
-    void addEllipse(const DRW_Ellipse&) override {}
-    void addPolyline(const DRW_Polyline&) override {}
-    void addSpline(const DRW_Spline*) override {}
     void addKnot(const DRW_Entity&) override {}
-    void addInsert(const DRW_Insert&) override {}
     void addTrace(const DRW_Trace&) override {}
     void add3dFace(const DRW_3Dface&) override {}
     void addSolid(const DRW_Solid&) override {}
@@ -88,10 +107,13 @@ public:
     DXFViewer() {
         auto* layout = new QVBoxLayout(this);
         auto* btnLoad = new QPushButton("Load DXF", this);
+        auto* btnNest = new QPushButton("Nest on sheet", this);
         auto* btnGcode = new QPushButton("Export G-code", this);
         layout->addWidget(btnLoad);
+        layout->addWidget(btnNest);
         layout->addWidget(btnGcode);
         connect(btnLoad, &QPushButton::clicked, this, &DXFViewer::loadDXF);
+        connect(btnNest, &QPushButton::clicked, this, &DXFViewer::nestSheet);
         connect(btnGcode, &QPushButton::clicked, this, &DXFViewer::exportGCode);
         setMinimumSize(800, 600);
     }
@@ -99,8 +121,15 @@ public:
     void loadDXF() {
         QString path = QFileDialog::getOpenFileName(this, "Open DXF", "", "*.dxf");
         if (path.isEmpty()) return;
-        polyline.clear();
-        layerPaths.clear();
+        layerPieces.clear();
+        layerContours.clear();
+        gaps.clear();
+        blocks.clear();
+        inserts.clear();
+        layerInstances.clear();
+        blockToolpaths.clear();
+        toolpathPreview.clear();
+        currentBlock = nullptr;
 
         DRW_Interface* iface = this;
         DRW_Header header;
@@ -111,80 +140,371 @@ public:
         //if (!dxfReader.read(&header)) {
        //     qWarning() << "Failed to read DXF.";
        // }
+        chainLayers();
+        buildPreview();
+        // Offsets and nesting work in fixed point, exact only up to a span.
+        if (!drawingPreview.empty()) {
+            const RectD& b = drawingPreview.bounds();
+            if (!withinExactExtent(b.right - b.left, b.bottom - b.top)) {
+                qWarning() << "The drawing spans" << b.right - b.left << "x" << b.bottom - b.top << "mm; past"
+                           << exact_extent_mm << "mm offsets and nesting may misjudge where contours cross";
+            }
+        }
         update();
     }
 
-    void exportGCode() {
-        QString code = "G21\nG90\nG0 Z5\nT1 M6\n";
-
-        for (const auto& [layer, paths] : layerPaths) {
-            bool isPocket = layer.find("pocket") != std::string::npos;
-            bool isContour = layer.find("cut") != std::string::npos;
-
-            auto toolRadius = currentTool.diameter / 2.0;
-            auto offsetPaths = InflatePaths(paths, isPocket ? -toolRadius : toolRadius, JoinType::Round, EndType::Polygon);
-
-            for (double depth = -currentTool.depth_per_pass; depth >= -currentTool.total_depth; depth -= currentTool.depth_per_pass) {
-                for (const auto& path : offsetPaths) {
-                    if (path.empty()) continue;
-                    code += QString("G0 X%1 Y%2\n").arg(path[0].x).arg(path[0].y);
-                    code += QString("G1 Z%1 F200\n").arg(depth);
-                    code += "G1 F300\n";
-                    for (size_t i = 1; i < path.size(); ++i) {
-                        code += QString("G1 X%1 Y%2\n").arg(path[i].x).arg(path[i].y);
-                    }
-                    code += "G0 Z5\n";
+    // Joins each layer's entities end to end, so a shape drawn as separate
+    // lines is cut as one contour. Blocks are chained once, in their own
+    // coordinates, and their inserts expanded to instances.
+    void chainLayers() {
+        for (const auto& [layer, pieces] : layerPieces) {
+            ChainReport report;
+            layerContours[layer] = chainContours(pieces, weld_tolerance, gap_report_distance, &report);
+            qDebug() << "Layer" << QString::fromStdString(layer) << ":" << pieces.size() << "entities ->"
+                     << report.closed << "closed," << report.open << "open contours";
+            for (const auto& gap : report.gaps) {
+                qDebug() << "  gap of" << gap.distance << "mm between" << gap.a.x << gap.a.y << "and" << gap.b.x << gap.b.y;
+            }
+            gaps.insert(gaps.end(), report.gaps.begin(), report.gaps.end());
+        }
+        for (auto& [name, block] : blocks) {
+            for (const auto& [layer, pieces] : block.layerPieces) {
+                block.layerContours[layer] = chainContours(pieces, weld_tolerance, gap_report_distance);
+            }
+        }
+        size_t instanceCount = 0;
+        for (auto& instance : expandInserts(inserts, blocks)) {
+            layerInstances[instance.layer].push_back(std::move(instance));
+            ++instanceCount;
+        }
+        qDebug() << blocks.size() << "blocks," << instanceCount << "placed block layers";
+    }
+
+    // Lays the drawing's parts out on the sheet, which then is the drawing.
+    // Loose contours are moved; block instances get the nest placement put
+    // on top of theirs, so they keep sharing their block's toolpaths. Parts
+    // that do not fit, and open contours outside every part, are left out.
+    void nestSheet() {
+        struct ItemSource {
+            std::string layer;
+            bool instance;
+            size_t index;
+        };
+        std::vector<ItemSource> sources;
+        std::vector<std::vector<Contour>> items;
+        for (const auto& [layer, contours] : layerContours) {
+            for (size_t i = 0; i < contours.size(); ++i) {
+                sources.push_back({ layer, false, i });
+                items.push_back({ contours[i] });
+            }
+        }
+        for (const auto& [layer, instances] : layerInstances) {
+            for (size_t i = 0; i < instances.size(); ++i) {
+                std::vector<Contour> placed;
+                for (const auto& c : blocks.at(instances[i].block).layerContours.at(instances[i].blockLayer)) {
+                    placed.push_back(placeContour(c, instances[i].placement, curve_tolerance));
+                }
+                sources.push_back({ layer, true, i });
+                items.push_back(std::move(placed));
+            }
+        }
+        NestGroups groups = groupParts(items);
+        if (groups.parts.empty()) return;
+
+        NestSettings settings;
+        settings.sheet_width = sheet_width;
+        settings.sheet_height = sheet_height;
+        settings.time_limit = nest_time_limit;
+        double widest = 0.0;
+        for (const auto& tool : toolLibrary.tools) widest = std::max(widest, tool.diameter);
+        settings.spacing = widest + nest_margin;
+        std::vector<std::vector<Contour>> outlines;
+        for (const auto& part : groups.parts) outlines.push_back(items[part[0]]);
+        NestResult result = nestParts(outlines, settings);
+
+        std::map<std::string, std::vector<Contour>> nestedContours;
+        std::map<std::string, std::vector<BlockInstance>> nestedInstances;
+        size_t unplaced = 0;
+        for (size_t p = 0; p < groups.parts.size(); ++p) {
+            if (!result.placed[p]) {
+                ++unplaced;
+                continue;
+            }
+            const Placement& placement = result.placements[p];
+            for (size_t item : groups.parts[p]) {
+                const ItemSource& source = sources[item];
+                if (source.instance) {
+                    BlockInstance instance = layerInstances[source.layer][source.index];
+                    instance.placement = instance.placement.then(placement);
+                    nestedInstances[source.layer].push_back(std::move(instance));
+                } else {
+                    nestedContours[source.layer].push_back(
+                        placeContour(layerContours[source.layer][source.index], placement, curve_tolerance));
                 }
             }
         }
+        layerContours = std::move(nestedContours);
+        layerInstances = std::move(nestedInstances);
+        qDebug() << "Nested" << groups.parts.size() - unplaced << "of" << groups.parts.size() << "parts in"
+                 << result.length << "mm of sheet," << result.utilisation * 100.0 << "% used,"
+                 << result.evaluations << "layouts tried";
+        if (unplaced) qWarning() << unplaced << "parts did not fit on the sheet and were left out";
+        if (!groups.strays.empty()) qWarning() << groups.strays.size() << "open contours outside every part were left out";
 
-        code += "M30\n";
+        gaps.clear();
+        toolpathPreview.clear();
+        buildPreview();
+        update();
+    }
+
+    // Tool centre paths for a set of contours: closed ones offset together,
+    // so holes stay holes, open ones followed as they are.
+    static std::vector<Contour> toolpathsFor(const std::vector<Contour>& contours, double delta, double tolerance) {
+        if (delta == 0.0) return contours;
+        std::vector<Contour> toolpaths = offsetContours(contours, delta, tolerance);
+        for (const auto& c : contours) {
+            if (!c.closed) toolpaths.push_back(c);
+        }
+        return toolpaths;
+    }
+
+    // An instance's toolpaths, placed. Rotated, moved and uniformly scaled
+    // copies share the block's toolpaths, offset by delta in block units;
+    // stretched ones have to be offset after placing.
+    void addInstanceToolpaths(const BlockInstance& instance, double delta, std::vector<Contour>& out) {
+        const auto& contours = blocks.at(instance.block).layerContours.at(instance.blockLayer);
+        const Placement& placement = instance.placement;
+        if (!placement.conformal()) {
+            std::vector<Contour> placed;
+            for (const auto& c : contours) placed.push_back(placeContour(c, placement, curve_tolerance));
+            for (auto& c : toolpathsFor(placed, delta, curve_tolerance)) out.push_back(std::move(c));
+            return;
+        }
+        double scale = placement.scale();
+        auto key = std::make_tuple(instance.block, instance.blockLayer, delta / scale);
+        auto it = blockToolpaths.find(key);
+        if (it == blockToolpaths.end()) {
+            it = blockToolpaths.emplace(key, toolpathsFor(contours, delta / scale, curve_tolerance / scale)).first;
+        }
+        for (const auto& c : it->second) out.push_back(placeContour(c, placement, curve_tolerance));
+    }
+
+    // Operations go in the planner's order, so each tool is loaded as few
+    // times as the engrave, pocket, profile order allows.
+    void exportGCode() {
+        QString code = "G21\nG90\nG0 Z5\n";
+        toolpathPreview.clear();
+        PointD position(0, 0);
+
+        std::set<std::string> layers;
+        for (const auto& entry : layerContours) layers.insert(entry.first);
+        for (const auto& entry : layerInstances) layers.insert(entry.first);
+        std::vector<PlannedOperation> plan = planOperations({ layers.begin(), layers.end() }, toolLibrary);
+        code += QString("(%1 operations, %2 tool loads)\n").arg(plan.size()).arg(toolLoads(plan));
+
+        int loaded = -1;
+        for (const auto& op : plan) {
+            const Tool& tool = *toolLibrary.tool(op.rule.tool);
+            if (tool.number != loaded) {
+                if (loaded >= 0) code += "M5\n";
+                code += QString("(%1)\nT%2 M6\nS%3 M3\n")
+                            .arg(QString::fromStdString(tool.name)).arg(tool.number).arg(tool.spindle_rpm);
+                loaded = tool.number;
+            }
+            code += QString("(%1 %2)\n").arg(operationName(op.rule.operation)).arg(QString::fromStdString(op.layer));
+
+            PassSettings passes;
+            passes.depth_per_pass = tool.depth_per_pass;
+            passes.total_depth = op.rule.depth;
+            passes.feed = tool.feed;
+            passes.plunge_feed = tool.plunge_feed;
+
+            // Engraving follows the lines; pockets keep inside them and
+            // profiles outside. Arcs stay arcs through the offset; block
+            // instances reuse their block's toolpaths.
+            double toolRadius = tool.cuttingRadius(op.rule.depth);
+            double delta = op.rule.operation == Operation::Engrave ? 0.0
+                         : op.rule.operation == Operation::Pocket  ? -toolRadius
+                                                                   : toolRadius;
+            std::vector<Contour> toolpaths;
+            auto loose = layerContours.find(op.layer);
+            if (loose != layerContours.end()) toolpaths = toolpathsFor(loose->second, delta, curve_tolerance);
+            auto instances = layerInstances.find(op.layer);
+            if (instances != layerInstances.end()) {
+                for (const auto& instance : instances->second) addInstanceToolpaths(instance, delta, toolpaths);
+            }
+
+            // Each contour all the way down before the next, insides first.
+            for (const auto& c : orderContours(toolpaths, passes, position)) {
+                code += contourPasses(c, passes);
+                toolpathPreview.add(c);
+            }
+        }
+
+        code += "M5\nM30\n";
         QFile f("lid_output.gcode");
         if (f.open(QIODevice::WriteOnly)) {
             f.write(code.toUtf8());
             f.close();
         }
+        update();
+    }
+
+    // The drawing, placed block instances included, goes into the preview
+    // cache once per load; the view then fits it.
+    void buildPreview() {
+        drawingPreview.clear();
+        for (const auto& [layer, contours] : layerContours) {
+            for (const auto& c : contours) drawingPreview.add(c);
+        }
+        for (const auto& [layer, instances] : layerInstances) {
+            for (const auto& instance : instances) {
+                for (const auto& c : blocks.at(instance.block).layerContours.at(instance.blockLayer)) {
+                    drawingPreview.add(placeContour(c, instance.placement, curve_tolerance));
+                }
+            }
+        }
+        if (drawingPreview.empty()) return;
+        const RectD& b = drawingPreview.bounds();
+        viewCenter = PointD(0.5 * (b.left + b.right), 0.5 * (b.top + b.bottom));
+        double w = std::max(b.right - b.left, 1e-3), h = std::max(b.bottom - b.top, 1e-3);
+        viewScale = 0.9 * std::min(width() / w, height() / h);
+        if (!(viewScale > 0.0)) viewScale = 1.0;
     }
 
     void paintEvent(QPaintEvent*) override {
         QPainter p(this);
         p.setRenderHint(QPainter::Antialiasing);
         p.translate(width() / 2, height() / 2);
-        p.scale(1, -1);
-        p.setPen(Qt::green);
-        for (const auto& pt : polyline) {
-            p.drawEllipse(pt, 1, 1);
+        p.scale(viewScale, -viewScale);
+        p.translate(-viewCenter.x, -viewCenter.y);
+        p.drawPicture(0, 0, drawingPreview.picture(viewScale));
+        if (!toolpathPreview.empty()) p.drawPicture(0, 0, toolpathPreview.picture(viewScale));
+
+        // Gap markers stay the same size on screen.
+        p.resetTransform();
+        p.setPen(Qt::red);
+        for (const auto& gap : gaps) {
+            for (const PointD& pt : { gap.a, gap.b }) {
+                QPointF at(width() / 2 + (pt.x - viewCenter.x) * viewScale, height() / 2 - (pt.y - viewCenter.y) * viewScale);
+                p.drawEllipse(at, 3, 3);
+            }
         }
-        for (size_t i = 1; i < polyline.size(); ++i) {
-            p.drawLine(polyline[i - 1], polyline[i]);
+    }
+
+    void mousePressEvent(QMouseEvent* event) override {
+        lastMouse = event->pos();
+    }
+
+    void mouseMoveEvent(QMouseEvent* event) override {
+        if (!(event->buttons() & Qt::LeftButton)) return;
+        QPoint delta = event->pos() - lastMouse;
+        lastMouse = event->pos();
+        viewCenter.x -= delta.x() / viewScale;
+        viewCenter.y += delta.y() / viewScale;
+        update();
+    }
+
+    void wheelEvent(QWheelEvent* event) override {
+        viewScale *= std::pow(zoom_step, event->angleDelta().y() / 120.0);
+        update();
+    }
+
+    // Block definitions are read as geometry of their own and placed by
+    // their inserts; only model space entities land in layerPieces.
+    void addBlock(const DRW_Block& data) override {
+        currentBlock = nullptr;
+        if (isModelSpace(data.name)) return;
+        currentBlock = &blocks[data.name];
+        currentBlock->base = PointD(data.basePoint.x, data.basePoint.y);
+    }
+
+    void endBlock() override { currentBlock = nullptr; }
+
+    // MINSERT arrays become one insert per cell, spaced along the rotated axes.
+    void addInsert(const DRW_Insert& data) override {
+        auto& target = currentBlock ? currentBlock->inserts : inserts;
+        double cs = std::cos(data.angle), sn = std::sin(data.angle);
+        for (int row = 0; row < std::max(1, data.rowcount); ++row) {
+            for (int col = 0; col < std::max(1, data.colcount); ++col) {
+                double dx = col * data.colspace, dy = row * data.rowspace;
+                PointD at(data.basePoint.x + cs * dx - sn * dy, data.basePoint.y + sn * dx + cs * dy);
+                target.push_back({ data.name, data.layer,
+                                   insertPlacement(at, data.xscale, data.yscale, data.angle) });
+            }
         }
     }
 
-    std::string currentLayer;
+    static bool isModelSpace(const std::string& name) {
+        QString n = QString::fromStdString(name).toLower();
+        return n == "*model_space" || n == "$model_space";
+    }
 
-    void setLayer(const std::string& name) {
-        currentLayer = name;
+    std::vector<Contour>& piecesFor(const std::string& layer) {
+        return (currentBlock ? currentBlock->layerPieces : layerPieces)[layer];
     }
 
+    // Entities go under their own layer name, which picks the operation.
+    // Arcs, circles and polyline bulges are kept as arcs; ellipses and
+    // splines are flattened to curve_tolerance.
     void addLine(const DRW_Line& data) override {
-        polyline.push_back(QPointF(data.basePoint.x, data.basePoint.y));
-        polyline.push_back(QPointF(data.secPoint.x, data.secPoint.y));
-        PathD path;
-        path.push_back({data.basePoint.x, data.basePoint.y});
-        path.push_back({data.secPoint.x, data.secPoint.y});
-        layerPaths[currentLayer].push_back(path);
+        Contour c;
+        c.points.push_back({data.basePoint.x, data.basePoint.y});
+        c.points.push_back({data.secPoint.x, data.secPoint.y});
+        piecesFor(data.layer).push_back(c);
     }
 
     void addLWPolyline(const DRW_LWPolyline& data) override {
-        PathD path;
+        Contour c;
         for (const auto& v : data.vertlist) {
-            polyline.push_back(QPointF(v->x, v->y));
-            path.push_back({v->x, v->y});
+            c.points.push_back({v->x, v->y});
+            c.bulges.push_back(v->bulge);
         }
-        if (data.flags & 1 && !path.empty()) {
-            path.push_back(path.front()); // close if needed
+        c.closed = data.flags & 1;
+        if (!c.closed && !c.bulges.empty()) c.bulges.pop_back(); // the last vertex's bulge only closes the loop
+        piecesFor(data.layer).push_back(c);
+    }
+
+    void addPolyline(const DRW_Polyline& data) override {
+        Contour c;
+        for (const auto& v : data.vertlist) {
+            c.points.push_back({v->basePoint.x, v->basePoint.y});
+            c.bulges.push_back(v->bulge);
+        }
+        c.closed = data.flags & 1;
+        if (!c.closed && !c.bulges.empty()) c.bulges.pop_back();
+        piecesFor(data.layer).push_back(c);
+    }
+
+    void addArc(const DRW_Arc& data) override {
+        double sweep = std::remainder(data.endangle - data.staangle, 2.0 * M_PI);
+        if (sweep <= 0.0) sweep += 2.0 * M_PI;
+        piecesFor(data.layer).push_back(
+            arcContour({data.basePoint.x, data.basePoint.y}, data.radious, data.staangle, sweep));
+    }
+
+    void addCircle(const DRW_Circle& data) override {
+        piecesFor(data.layer).push_back(circleContour({data.basePoint.x, data.basePoint.y}, data.radious));
+    }
+
+    void addEllipse(const DRW_Ellipse& data) override {
+        piecesFor(data.layer).push_back(ellipseContour({data.basePoint.x, data.basePoint.y},
+                                                         {data.secPoint.x, data.secPoint.y}, data.ratio,
+                                                         data.staparam, data.endparam, curve_tolerance));
+    }
+
+    void addSpline(const DRW_Spline* data) override {
+        std::vector<PointD> control;
+        for (const auto& p : data->controllist) control.push_back({p->x, p->y});
+        if (control.empty()) {
+            // Fit points only: follow them.
+            Contour c;
+            for (const auto& p : data->fitlist) c.points.push_back({p->x, p->y});
+            piecesFor(data->layer).push_back(c);
+            return;
         }
-        layerPaths[currentLayer].push_back(path);
+        piecesFor(data->layer).push_back(
+            splineContour(control, data->weightlist, data->knotslist, data->degree, curve_tolerance));
     }
 };
 
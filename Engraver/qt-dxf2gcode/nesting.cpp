@@ -0,0 +1,349 @@
+// nesting.cpp
+// Positions are those of a shape's bounding box corner, in fixed-point
+// units, so the feasible region of a part is exact Clipper arithmetic: the
+// sheet's inner fit rectangle minus the no-fit polygons of the placed parts,
+// and its lowest vertex is the bottom-left position.
+
+#include "nesting.h"
+#include "fixedpoint.h"
+#include "parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <random>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+const double nest_tolerance = 0.1;     // mm; chord error of the outlines, added to the spacing
+const double shape_match = 0.01;       // mm; outlines this close share one shape
+const double unplaced_weight = 2.0;    // an unplaced part costs this many times the strip it needs
+const double start_temperature = 0.05; // of the first layout's cost
+
+// One part at one rotation, with half the spacing around it.
+struct Shape {
+    Paths64 outline;   // outer paths only, bounding box corner at the origin
+    int64_t width = 0, height = 0;
+};
+
+struct Layout {
+    std::vector<size_t> order;
+    std::vector<int> rotation;       // per part; -1 if it did not fit
+    std::vector<Point64> position;   // per part
+    double length = 0.0;
+    double cost = 0.0;
+};
+
+PathsD rotated(const PathsD& paths, double degrees) {
+    double cs = std::cos(degrees * pi / 180.0), sn = std::sin(degrees * pi / 180.0);
+    PathsD out = paths;
+    for (auto& path : out) {
+        for (auto& p : path) p = PointD(cs * p.x - sn * p.y, sn * p.x + cs * p.y);
+    }
+    return out;
+}
+
+Path64 negated(const Path64& path) {
+    Path64 out;
+    out.reserve(path.size());
+    for (const auto& p : path) out.push_back(Point64(-p.x, -p.y));
+    return out;
+}
+
+class Nester {
+public:
+    Nester(const std::vector<std::vector<Contour>>& outlines, const NestSettings& settings) : settings_(settings) {
+        std::vector<double> rotations = settings.rotations.empty() ? std::vector<double>{ 0.0 } : settings.rotations;
+        std::map<std::vector<int64_t>, int> known;
+        for (const auto& contours : outlines) {
+            PathsD flat;
+            for (const auto& c : contours) {
+                if (c.closed) flat.push_back(flattenContour(c, nest_tolerance));
+            }
+            flat = Union(flat, FillRule::NonZero);
+            area_.push_back(std::fabs(Area(flat)));
+            std::vector<int> ids;
+            std::vector<PointD> corners;
+            for (double degrees : rotations) {
+                // Brought to the origin before rounding to units, so that
+                // copies of a part round alike wherever they are drawn. The
+                // round joins are thinned to shape_match (and grown by as
+                // much) to keep the no-fit polygons small.
+                PathsD turned = rotated(flat, degrees);
+                RectD at = GetBounds(turned);
+                Paths64 grown = InflatePaths(toUnits(TranslatePaths(turned, -at.left, -at.top)),
+                                             (settings.spacing / 2.0 + nest_tolerance + shape_match) * units_per_mm,
+                                             JoinType::Round, EndType::Polygon, 2.0, nest_tolerance * units_per_mm);
+                grown = SimplifyPaths(grown, shape_match * units_per_mm);
+                Shape shape;
+                Rect64 box = GetBounds(grown);
+                PointD offset = toMm(Point64(box.left, box.top));
+                corners.push_back(PointD(at.left + offset.x, at.top + offset.y));
+                for (const auto& path : grown) {
+                    if (Area(path) <= 0.0) continue;   // holes take no part in the nest
+                    shape.outline.push_back(TranslatePath(path, -box.left, -box.top));
+                }
+                Rect64 bounds = GetBounds(shape.outline);
+                shape.width = bounds.right;
+                shape.height = bounds.bottom;
+
+                // Identical outlines, as with repeated parts, share one shape
+                // and so their no-fit polygons. Copies can still round a unit
+                // apart, so they are compared on a coarser grid.
+                const double grid = shape_match * units_per_mm;
+                std::vector<int64_t> key;
+                for (const auto& path : shape.outline) {
+                    key.push_back(static_cast<int64_t>(path.size()));
+                    for (const auto& pt : path) {
+                        key.push_back(std::llround(pt.x / grid));
+                        key.push_back(std::llround(pt.y / grid));
+                    }
+                }
+                auto it = known.find(key);
+                if (it == known.end()) {
+                    it = known.emplace(key, static_cast<int>(shapes_.size())).first;
+                    shapes_.push_back(std::move(shape));
+                }
+                ids.push_back(it->second);
+            }
+            shapeOf_.push_back(std::move(ids));
+            corner_.push_back(std::move(corners));
+        }
+        angles_ = rotations;
+    }
+
+    size_t partCount() const { return shapeOf_.size(); }
+    double partArea(size_t part) const { return area_[part]; }
+
+    Layout place(const std::vector<size_t>& order) {
+        Layout layout;
+        layout.order = order;
+        layout.rotation.assign(partCount(), -1);
+        layout.position.assign(partCount(), Point64(0, 0));
+        // Outlines carry half the spacing, so the other half is kept off
+        // the sheet edge here.
+        int64_t margin = toUnits(settings_.spacing / 2.0);
+        int64_t sheetW = toUnits(settings_.sheet_width) - 2 * margin;
+        int64_t sheetH = toUnits(settings_.sheet_height) - 2 * margin;
+        int64_t top = 0;
+        double unplaced = 0.0;
+        std::vector<size_t> placed;
+
+        for (size_t part : order) {
+            bool found = false;
+            Point64 best;
+            int bestRotation = -1;
+            for (size_t r = 0; r < shapeOf_[part].size(); ++r) {
+                const Shape& moving = shapes_[shapeOf_[part][r]];
+                if (moving.width > sheetW || moving.height > sheetH) continue;
+                Paths64 fit = { Rect64(margin, margin, margin + sheetW - moving.width,
+                                       margin + sheetH - moving.height).AsPath() };
+                Paths64 blocked;
+                for (size_t other : placed) {
+                    const Point64& at = layout.position[other];
+                    const Paths64& nfp = noFit(shapeOf_[other][layout.rotation[other]], shapeOf_[part][r]);
+                    for (const auto& path : nfp) blocked.push_back(TranslatePath(path, at.x, at.y));
+                }
+                Paths64 free = blocked.empty() ? fit : Difference(fit, blocked, FillRule::NonZero);
+                for (const auto& path : free) {
+                    for (const auto& p : path) {
+                        if (!found || p.y < best.y || (p.y == best.y && p.x < best.x)) {
+                            found = true;
+                            best = p;
+                            bestRotation = static_cast<int>(r);
+                        }
+                    }
+                }
+            }
+            if (!found) {
+                unplaced += area_[part];
+                continue;
+            }
+            layout.rotation[part] = bestRotation;
+            layout.position[part] = best;
+            top = std::max(top, best.y + shapes_[shapeOf_[part][bestRotation]].height);
+            placed.push_back(part);
+        }
+        layout.length = placed.empty() ? 0.0 : toMm(static_cast<double>(top + margin));
+        layout.cost = layout.length + unplaced_weight * unplaced / settings_.sheet_width;
+        return layout;
+    }
+
+    Placement placement(const Layout& layout, size_t part) const {
+        int r = layout.rotation[part];
+        const PointD& corner = corner_[part][r];
+        double cs = std::cos(angles_[r] * pi / 180.0), sn = std::sin(angles_[r] * pi / 180.0);
+        Placement p;
+        p.a = cs;
+        p.b = -sn;
+        p.c = sn;
+        p.d = cs;
+        PointD at = toMm(layout.position[part]);
+        p.tx = at.x - corner.x;
+        p.ty = at.y - corner.y;
+        return p;
+    }
+
+private:
+    // Positions of moving's corner, relative to fixed's, where the two
+    // overlap: fixed (+) -moving. MinkowskiSum only sweeps the boundary, so
+    // each pair is filled in with one shape moved to a point of the other.
+    const Paths64& noFit(int fixed, int moving) {
+        auto key = std::make_pair(fixed, moving);
+        {
+            std::lock_guard<std::mutex> lock(nfpMutex_);
+            auto it = nfps_.find(key);
+            if (it != nfps_.end()) return it->second;
+        }
+        Paths64 parts;
+        for (const auto& a : shapes_[fixed].outline) {
+            for (const auto& b : shapes_[moving].outline) {
+                Path64 minusB = negated(b);
+                for (auto& path : MinkowskiSum(minusB, a, true)) parts.push_back(std::move(path));
+                parts.push_back(TranslatePath(a, minusB[0].x, minusB[0].y));
+                parts.push_back(TranslatePath(minusB, a[0].x, a[0].y));
+            }
+        }
+        Paths64 nfp = Union(parts, FillRule::NonZero);
+        // Where the swept quads meet at rounded vertices they can leave
+        // slivers of holes, which bottom-left fill would drop a part into.
+        const double min_hole = nest_tolerance * nest_tolerance * units_per_mm * units_per_mm;
+        nfp.erase(std::remove_if(nfp.begin(), nfp.end(),
+                                 [min_hole](const Path64& path) { return Area(path) < 0.0 && -Area(path) < min_hole; }),
+                  nfp.end());
+        std::lock_guard<std::mutex> lock(nfpMutex_);
+        return nfps_.emplace(key, std::move(nfp)).first->second;
+    }
+
+    const NestSettings& settings_;
+    std::vector<Shape> shapes_;
+    std::vector<std::vector<int>> shapeOf_;   // part, rotation -> shape
+    std::vector<std::vector<PointD>> corner_; // part, rotation -> mm; where its shape's corner was before moving
+    std::vector<double> angles_;
+    std::vector<double> area_;                // mm^2, without the spacing
+    std::mutex nfpMutex_;
+    std::map<std::pair<int, int>, Paths64> nfps_;
+};
+
+} // namespace
+
+NestGroups groupParts(const std::vector<std::vector<Contour>>& items) {
+    size_t n = items.size();
+    std::vector<PathsD> closed(n);
+    std::vector<RectD> bounds(n);
+    std::vector<double> area(n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        for (const auto& c : items[i]) {
+            if (!c.closed) continue;
+            PathD flat = flattenContour(c, nest_tolerance);
+            if (flat.size() < 3) continue;
+            area[i] = std::max(area[i], std::fabs(Area(flat)));
+            closed[i].push_back(std::move(flat));
+        }
+        if (!closed[i].empty()) bounds[i] = GetBounds(closed[i]);
+    }
+
+    // Each item goes with the largest item whose closed contours hold its
+    // first point. Outlines can overlap without nesting, so that one may be
+    // held in turn; the part is the top of the chain, which is always larger.
+    std::vector<size_t> holder(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        if (items[i].empty() || items[i][0].points.empty()) continue;
+        const PointD& p = items[i][0].points[0];
+        for (size_t j = 0; j < n; ++j) {
+            if (j == i || closed[j].empty() || area[j] <= area[i]) continue;
+            if (holder[i] < n && area[holder[i]] >= area[j]) continue;
+            const RectD& b = bounds[j];
+            if (p.x < b.left || p.x > b.right || p.y < b.top || p.y > b.bottom) continue;
+            for (const auto& path : closed[j]) {
+                if (PointInPolygon(p, path) == PointInPolygonResult::IsInside) {
+                    holder[i] = j;
+                    break;
+                }
+            }
+        }
+    }
+
+    NestGroups groups;
+    std::vector<size_t> partOf(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        if (holder[i] < n) continue;
+        if (closed[i].empty()) {
+            groups.strays.push_back(i);
+            continue;
+        }
+        partOf[i] = groups.parts.size();
+        groups.parts.push_back({ i });
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (holder[i] == n) continue;
+        size_t top = holder[i];
+        while (holder[top] < n) top = holder[top];
+        if (partOf[top] < n) groups.parts[partOf[top]].push_back(i);
+    }
+    return groups;
+}
+
+NestResult nestParts(const std::vector<std::vector<Contour>>& outlines, const NestSettings& settings) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    Nester nester(outlines, settings);
+    size_t n = nester.partCount();
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return nester.partArea(a) > nester.partArea(b); });
+    Layout current = nester.place(order);
+    Layout best = current;
+    size_t evaluations = 1;
+
+    unsigned threads = settings.threads ? settings.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::mt19937 rng(settings.seed);
+    double t0 = start_temperature * std::max(current.cost, 1.0);
+    auto elapsed = [&]() { return std::chrono::duration<double>(Clock::now() - start).count(); };
+    while (n > 1 && elapsed() < settings.time_limit) {
+        // One neighbour per thread: two parts swapped, or one moved.
+        std::vector<std::vector<size_t>> candidates(threads, current.order);
+        for (auto& c : candidates) {
+            size_t i = rng() % n, j = rng() % n;
+            if (rng() % 2) {
+                std::swap(c[i], c[j]);
+            } else if (i < j) {
+                std::rotate(c.begin() + i, c.begin() + i + 1, c.begin() + j + 1);
+            } else {
+                std::rotate(c.begin() + j, c.begin() + i, c.begin() + i + 1);
+            }
+        }
+        std::vector<Layout> tried(threads);
+        parallelFor(threads, [&](size_t k) { tried[k] = nester.place(candidates[k]); }, threads);
+        evaluations += threads;
+
+        const Layout& next = *std::min_element(tried.begin(), tried.end(),
+                                               [](const Layout& a, const Layout& b) { return a.cost < b.cost; });
+        double temperature = t0 * std::max(0.0, 1.0 - elapsed() / settings.time_limit) + 1e-9;
+        double delta = next.cost - current.cost;
+        if (delta <= 0.0 || std::generate_canonical<double, 32>(rng) < std::exp(-delta / temperature)) current = next;
+        if (current.cost < best.cost) best = current;
+    }
+
+    NestResult result;
+    result.placements.resize(n);
+    result.placed.assign(n, false);
+    double area = 0.0;
+    for (size_t part = 0; part < n; ++part) {
+        if (best.rotation[part] < 0) continue;
+        result.placed[part] = true;
+        result.placements[part] = nester.placement(best, part);
+        area += nester.partArea(part);
+    }
+    result.length = best.length;
+    result.utilisation = best.length > 0.0 ? area / (settings.sheet_width * best.length) : 0.0;
+    result.evaluations = evaluations;
+    return result;
+}
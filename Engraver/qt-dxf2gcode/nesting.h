@@ -0,0 +1,50 @@
+// nesting.h
+// Lays parts out on a sheet: no-fit polygons, bottom-left fill and an annealed part order
+
+#ifndef NESTING_H
+#define NESTING_H
+
+#include <vector>
+#include "blocks.h"
+#include "curves.h"
+
+struct NestSettings {
+    double sheet_width = 600.0;    // mm, along X from the origin
+    double sheet_height = 400.0;   // mm, along Y
+    double spacing = 8.0;          // mm between parts, and from a part to the sheet edge
+    std::vector<double> rotations = { 0.0, 90.0, 180.0, 270.0 };   // degrees a part may turn
+    double time_limit = 5.0;       // seconds for the order search
+    unsigned threads = 0;          // 0 = one per core
+    unsigned seed = 1;
+};
+
+// Parts found in a drawing. Each part is an item that lies inside no other
+// (its closed contours are what the nester keeps apart) and the items inside
+// it, which move with it. Items with no closed contour that lie inside
+// nothing belong to no part and come back as strays.
+struct NestGroups {
+    std::vector<std::vector<size_t>> parts;   // the outer item first
+    std::vector<size_t> strays;
+};
+
+NestGroups groupParts(const std::vector<std::vector<Contour>>& items);
+
+struct NestResult {
+    std::vector<Placement> placements;   // per part, onto the sheet
+    std::vector<bool> placed;            // false for parts that did not fit
+    double length = 0.0;                 // mm of the sheet height used
+    double utilisation = 0.0;            // part area over the sheet width times length
+    size_t evaluations = 0;              // layouts the search tried
+};
+
+// A part's outline is the closed contours given for it, grown by half the
+// spacing. The no-fit polygon of each pair of outlines at each pair of
+// rotations comes from Clipper's MinkowskiSum and is computed once, so a
+// sheet of identical parts costs one per rotation pair. Parts are placed in
+// order, each at the lowest, then leftmost, position over all rotations
+// that keeps it spacing inside the sheet edge and off every placed part.
+// The order starts largest first and is then annealed for time_limit
+// seconds, each round trying one neighbouring order per thread in parallel.
+NestResult nestParts(const std::vector<std::vector<Contour>>& outlines, const NestSettings& settings);
+
+#endif // NESTING_H
@@ -0,0 +1,183 @@
+// passplan.cpp
+// Ordering is a greedy nearest-neighbour walk over the contours whose
+// contents are already cut, which keeps it O(n^2) with no search.
+
+#include "passplan.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+// Chord error for the containment tests only; nothing cut uses it.
+const double containment_tolerance = 0.05;
+
+double distance(const PointD& a, const PointD& b) {
+    return std::hypot(b.x - a.x, b.y - a.y);
+}
+
+double segmentLength(const Contour& c, size_t i) {
+    const PointD& a = c.points[i];
+    const PointD& b = c.points[(i + 1) % c.points.size()];
+    double bulge = c.bulge(i);
+    if (bulge == 0.0) return distance(a, b);
+    ArcGeometry arc = bulgeArc(a, b, bulge);
+    return arc.radius * std::fabs(arc.sweep);
+}
+
+Contour reversed(const Contour& c) {
+    Contour r;
+    r.closed = c.closed;
+    r.points.assign(c.points.rbegin(), c.points.rend());
+    for (size_t i = c.segmentCount(); i-- > 0;) r.bulges.push_back(-c.bulge(i));
+    return r;
+}
+
+Contour rotated(const Contour& c, size_t start) {
+    Contour r = c;
+    std::rotate(r.points.begin(), r.points.begin() + start, r.points.end());
+    if (r.bulges.size() == r.points.size()) std::rotate(r.bulges.begin(), r.bulges.begin() + start, r.bulges.end());
+    return r;
+}
+
+// One run along the contour from z_from to z_to, spread by length.
+void rampRun(const Contour& c, double z_from, double z_to, QString& code) {
+    double total = 0.0;
+    for (size_t i = 0; i < c.segmentCount(); ++i) total += segmentLength(c, i);
+    double done = 0.0;
+    for (size_t i = 0; i < c.segmentCount(); ++i) {
+        const PointD& a = c.points[i];
+        const PointD& b = c.points[(i + 1) % c.points.size()];
+        done += segmentLength(c, i);
+        double z = total > 0.0 ? z_from + (z_to - z_from) * done / total : z_to;
+        double bulge = c.bulge(i);
+        if (bulge == 0.0) {
+            code += QString("G1 X%1 Y%2 Z%3\n").arg(b.x).arg(b.y).arg(z);
+        } else {
+            ArcGeometry arc = bulgeArc(a, b, bulge);
+            code += QString("%1 X%2 Y%3 Z%4 I%5 J%6\n")
+                        .arg(bulge < 0.0 ? "G2" : "G3")
+                        .arg(b.x).arg(b.y).arg(z)
+                        .arg(arc.center.x - a.x).arg(arc.center.y - a.y);
+        }
+    }
+}
+
+// Runs contourPasses makes along an open contour.
+size_t openRuns(const PassSettings& settings) {
+    return passDepths(settings).size() + 1;
+}
+
+} // namespace
+
+std::vector<double> passDepths(const PassSettings& settings) {
+    std::vector<double> depths;
+    if (settings.depth_per_pass <= 0.0 || settings.total_depth <= 0.0) return depths;
+    size_t passes = static_cast<size_t>(std::ceil(settings.total_depth / settings.depth_per_pass - 1e-9));
+    for (size_t k = 1; k <= passes; ++k) depths.push_back(-std::min(k * settings.depth_per_pass, settings.total_depth));
+    return depths;
+}
+
+std::vector<Contour> orderContours(const std::vector<Contour>& contours, const PassSettings& settings,
+                                   PointD& position) {
+    size_t n = contours.size();
+
+    // Which closed contours hold which others.
+    std::vector<PathD> outlines(n);
+    std::vector<RectD> bounds(n);
+    std::vector<double> areas(n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        outlines[i] = flattenContour(contours[i], containment_tolerance);
+        bounds[i] = GetBounds(outlines[i]);
+        if (contours[i].closed) areas[i] = std::fabs(Area(outlines[i]));
+    }
+    std::vector<std::vector<size_t>> holders(n);   // closed contours that contain i
+    std::vector<size_t> inside(n, 0);              // contours still to cut inside i
+    for (size_t i = 0; i < n; ++i) {
+        if (contours[i].points.empty()) continue;
+        const PointD& p = contours[i].points[0];
+        for (size_t j = 0; j < n; ++j) {
+            if (j == i || !contours[j].closed || areas[j] <= areas[i]) continue;
+            const RectD& b = bounds[j];
+            if (p.x < b.left || p.x > b.right || p.y < b.top || p.y > b.bottom) continue;
+            if (PointInPolygon(p, outlines[j]) != PointInPolygonResult::IsInside) continue;
+            holders[i].push_back(j);
+            ++inside[j];
+        }
+    }
+
+    std::vector<Contour> order;
+    std::vector<bool> done(n, false);
+    bool evenOpenRuns = openRuns(settings) % 2 == 0;
+    for (size_t step = 0; step < n; ++step) {
+        // Nearest start among the contours with nothing left inside them.
+        size_t best = n, bestVertex = 0;
+        bool bestReversed = false;
+        double bestD = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            if (done[i] || inside[i] > 0 || contours[i].points.empty()) continue;
+            const PathD& pts = contours[i].points;
+            if (contours[i].closed) {
+                for (size_t v = 0; v < pts.size(); ++v) {
+                    double d = distance(position, pts[v]);
+                    if (best == n || d < bestD) {
+                        best = i;
+                        bestVertex = v;
+                        bestReversed = false;
+                        bestD = d;
+                    }
+                }
+            } else {
+                double d0 = distance(position, pts.front()), d1 = distance(position, pts.back());
+                if (best == n || std::min(d0, d1) < bestD) {
+                    best = i;
+                    bestVertex = 0;
+                    bestReversed = d1 < d0;
+                    bestD = std::min(d0, d1);
+                }
+            }
+        }
+        if (best == n) break;
+
+        const Contour& c = contours[best];
+        Contour next = c.closed ? rotated(c, bestVertex) : (bestReversed ? reversed(c) : c);
+        position = (next.closed || evenOpenRuns) ? next.points.front() : next.points.back();
+        order.push_back(std::move(next));
+        done[best] = true;
+        for (size_t j : holders[best]) --inside[j];
+    }
+    return order;
+}
+
+QString contourPasses(const Contour& contour, const PassSettings& settings) {
+    QString code;
+    if (contour.points.size() < 2) return code;
+    std::vector<double> depths = passDepths(settings);
+    if (depths.empty()) return code;
+
+    const PointD& start = contour.points[0];
+    code += QString("G0 X%1 Y%2\n").arg(start.x).arg(start.y);
+    code += QString("G1 Z0 F%1\n").arg(settings.plunge_feed);
+    code += QString("G1 F%1\n").arg(settings.feed);
+
+    double z = 0.0;
+    if (contour.closed) {
+        for (double depth : depths) {
+            rampRun(contour, z, depth, code);
+            z = depth;
+        }
+        rampRun(contour, z, z, code);
+    } else {
+        Contour back = reversed(contour);
+        bool forward = true;
+        for (double depth : depths) {
+            rampRun(forward ? contour : back, z, depth, code);
+            z = depth;
+            forward = !forward;
+        }
+        rampRun(forward ? contour : back, z, z, code);
+    }
+    code += QString("G0 Z%1\n").arg(settings.safe_z);
+    return code;
+}
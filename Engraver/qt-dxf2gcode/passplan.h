@@ -0,0 +1,37 @@
+// passplan.h
+// Cut order and depth passes: each contour goes to full depth before the next
+
+#ifndef PASSPLAN_H
+#define PASSPLAN_H
+
+#include <QString>
+#include <vector>
+#include "clipper2/clipper.h"
+#include "curves.h"
+
+struct PassSettings {
+    double depth_per_pass = 1.5;
+    double total_depth = 4.5;
+    double safe_z = 5.0;
+    double plunge_feed = 200.0;
+    double feed = 300.0;
+};
+
+// Pass depths down to total_depth, the last one exactly at it.
+std::vector<double> passDepths(const PassSettings& settings);
+
+// Orders contours so that everything inside a closed contour is cut before
+// it (holes and features before the cut-out), and otherwise goes to the
+// nearest start from where the tool is. Closed contours are rotated to start
+// at their vertex nearest the tool and open ones may be reversed. position
+// is where the tool starts and, on return, where contourPasses leaves it.
+std::vector<Contour> orderContours(const std::vector<Contour>& contours, const PassSettings& settings,
+                                   Clipper2Lib::PointD& position);
+
+// All passes of one contour with a single plunge to the surface and one
+// retract. Closed contours ramp down one pass per lap (helically on arcs)
+// and finish with a flat lap at full depth; open ones ramp along their
+// length, reversing direction each pass.
+QString contourPasses(const Contour& contour, const PassSettings& settings);
+
+#endif // PASSPLAN_H
@@ -0,0 +1,85 @@
+// previewcache.cpp
+// Thinning drops points closer than the tolerance to the last one kept,
+// which is what keeps dense splines and hatch-like detail cheap when zoomed out.
+
+#include "previewcache.h"
+#include <QPainter>
+#include <QPen>
+#include <QPolygonF>
+#include <algorithm>
+#include <cmath>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+const double pixel_tolerance = 0.5;    // pixels; detail finer than this is not drawn
+const double bounds_tolerance = 0.1;   // mm; chord error for the bounds of arcs
+const size_t max_cached_levels = 8;
+
+} // namespace
+
+void PreviewCache::clear() {
+    contours_.clear();
+    boxes_.clear();
+    bounds_ = RectD(0, 0, 0, 0);
+    levels_.clear();
+}
+
+void PreviewCache::add(const Contour& contour) {
+    if (contour.points.empty()) return;
+    RectD box = GetBounds(flattenContour(contour, bounds_tolerance));
+    if (contours_.empty()) {
+        bounds_ = box;
+    } else {
+        bounds_.left = std::min(bounds_.left, box.left);
+        bounds_.top = std::min(bounds_.top, box.top);
+        bounds_.right = std::max(bounds_.right, box.right);
+        bounds_.bottom = std::max(bounds_.bottom, box.bottom);
+    }
+    contours_.push_back(contour);
+    boxes_.push_back(box);
+    levels_.clear();
+}
+
+const QPicture& PreviewCache::picture(double pixels_per_mm) {
+    int level = static_cast<int>(std::floor(std::log2(pixel_tolerance / std::max(pixels_per_mm, 1e-9))));
+    auto it = levels_.find(level);
+    if (it != levels_.end()) return it->second;
+    if (levels_.size() >= max_cached_levels) levels_.clear();
+    return levels_.emplace(level, record(std::ldexp(1.0, level))).first->second;
+}
+
+QPicture PreviewCache::record(double tolerance) const {
+    QPicture picture;
+    QPainter p(&picture);
+    QPen closedPen(closed_), openPen(open_);
+    closedPen.setCosmetic(true);
+    openPen.setCosmetic(true);
+    for (size_t i = 0; i < contours_.size(); ++i) {
+        const Contour& c = contours_[i];
+        const RectD& box = boxes_[i];
+        p.setPen(c.closed ? closedPen : openPen);
+        if (box.right - box.left < tolerance && box.bottom - box.top < tolerance) {
+            p.drawPoint(QPointF(0.5 * (box.left + box.right), 0.5 * (box.top + box.bottom)));
+            continue;
+        }
+        PathD flat = flattenContour(c, tolerance);
+        QPolygonF poly;
+        poly << QPointF(flat[0].x, flat[0].y);
+        PointD kept = flat[0];
+        for (size_t k = 1; k < flat.size(); ++k) {
+            bool last = k + 1 == flat.size();
+            if (!last && std::fabs(flat[k].x - kept.x) < tolerance && std::fabs(flat[k].y - kept.y) < tolerance) continue;
+            poly << QPointF(flat[k].x, flat[k].y);
+            kept = flat[k];
+        }
+        if (c.closed) {
+            p.drawPolygon(poly);
+        } else {
+            p.drawPolyline(poly);
+        }
+    }
+    p.end();
+    return picture;
+}
@@ -0,0 +1,41 @@
+// previewcache.h
+// Contours recorded once into QPictures, one per level of detail
+
+#ifndef PREVIEWCACHE_H
+#define PREVIEWCACHE_H
+
+#include <QColor>
+#include <QPicture>
+#include <map>
+#include <vector>
+#include "clipper2/clipper.h"
+#include "curves.h"
+
+// Pictures are recorded in mm with cosmetic pens, so a repaint only sets the
+// view transform and replays one. Each level flattens and thins the contours
+// to about half a pixel at its zoom, and contours smaller than that become a
+// single point. Levels step in powers of two, so zooming within a factor of
+// two replays the same picture and only a new level costs a rebuild.
+class PreviewCache {
+public:
+    PreviewCache(const QColor& closed, const QColor& open) : closed_(closed), open_(open) {}
+
+    void clear();
+    void add(const Contour& contour);
+    bool empty() const { return contours_.empty(); }
+    // Of everything added, arcs included; empty when nothing is.
+    const Clipper2Lib::RectD& bounds() const { return bounds_; }
+
+    const QPicture& picture(double pixels_per_mm);
+
+private:
+    QPicture record(double tolerance) const;
+
+    QColor closed_, open_;
+    std::vector<Contour> contours_;
+    std::vector<Clipper2Lib::RectD> boxes_;
+    Clipper2Lib::RectD bounds_ = Clipper2Lib::RectD(0, 0, 0, 0);
+    std::map<int, QPicture> levels_;   // by log2 of the tolerance
+};
+
+#endif // PREVIEWCACHE_H
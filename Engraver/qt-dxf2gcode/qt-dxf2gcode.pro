@@ -16,12 +16,37 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
-    clipper.engine.cpp \
-    clipper.offset.cpp \
-    clipper.rectclip.cpp \
-    main.cpp
+    arcoffset.cpp \
+    blocks.cpp \
+    contourchain.cpp \
+    curves.cpp \
+    jobplanner.cpp \
+    main.cpp \
+    nesting.cpp \
+    passplan.cpp \
+    previewcache.cpp \
+    toollibrary.cpp \
+    ../greypocket/clipper.engine.cpp \
+    ../greypocket/clipper.offset.cpp \
+    ../greypocket/clipper.rectclip.cpp \
+    ../greypocket/clipper.tiled.cpp
 
 HEADERS += \
+    arcoffset.h \
+    blocks.h \
+    contourchain.h \
+    curves.h \
+    jobplanner.h \
+    nesting.h \
+    passplan.h \
+    previewcache.h \
+    toollibrary.h \
+    ../greypocket/fixedpoint.h \
+    ../greypocket/parallel.h
+
+# Clipper2, with the parallel offset, pooled allocation and tiled booleans,
+# and the fixed-point helpers are greypocket's; one copy serves every tool.
+INCLUDEPATH += ../greypocket
 
 FORMS += \
 
@@ -0,0 +1,85 @@
+// toollibrary.cpp
+// Layer names are matched case-insensitively, so "Pocket_T2" and "POCKET"
+// pick the same rule.
+
+#include "toollibrary.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+// The n of a "T<n>" standing on its own in the name, or -1.
+int toolInName(const std::string& layer) {
+    for (size_t i = 0; i < layer.size(); ++i) {
+        if (layer[i] != 'T' && layer[i] != 't') continue;
+        if (i > 0 && std::isalnum(static_cast<unsigned char>(layer[i - 1]))) continue;
+        size_t end = i + 1;
+        while (end < layer.size() && std::isdigit(static_cast<unsigned char>(layer[end]))) ++end;
+        if (end == i + 1 || (end < layer.size() && std::isalpha(static_cast<unsigned char>(layer[end])))) continue;
+        return std::stoi(layer.substr(i + 1, end - i - 1));
+    }
+    return -1;
+}
+
+} // namespace
+
+double Tool::cuttingRadius(double depth) const {
+    if (type != VBit) return diameter / 2.0;
+    return std::min(diameter / 2.0, depth * std::tan(v_angle_deg * pi / 360.0));
+}
+
+const char* operationName(Operation operation) {
+    switch (operation) {
+    case Operation::Engrave: return "engrave";
+    case Operation::Pocket: return "pocket";
+    case Operation::Profile: return "profile";
+    }
+    return "";
+}
+
+const Tool* ToolLibrary::tool(int number) const {
+    for (const auto& t : tools) {
+        if (t.number == number) return &t;
+    }
+    return nullptr;
+}
+
+LayerRule ToolLibrary::ruleFor(const std::string& layer) const {
+    std::string name = lower(layer);
+    LayerRule rule = fallback;
+    for (const auto& r : rules) {
+        if (name.find(lower(r.match)) != std::string::npos) {
+            rule = r;
+            break;
+        }
+    }
+    int number = toolInName(layer);
+    if (number >= 0 && tool(number)) rule.tool = number;
+    return rule;
+}
+
+ToolLibrary defaultToolLibrary() {
+    ToolLibrary library;
+    library.tools = {
+        { 1, "3.175 mm flat end mill", FlatEnd, 3.175, 1.0, 800.0, 200.0, 18000.0, 0.0 },
+        { 2, "6 mm T-slot cutter", TSlot, 6.0, 1.5, 300.0, 150.0, 12000.0, 0.0 },
+        { 3, "60 degree V-bit", VBit, 6.0, 0.5, 600.0, 200.0, 18000.0, 60.0 },
+    };
+    library.rules = {
+        { "engrave", Operation::Engrave, 3, 0.5 },
+        { "pocket", Operation::Pocket, 1, 4.5 },
+        { "tslot", Operation::Profile, 2, 4.5 },
+        { "cut", Operation::Profile, 1, 4.5 },
+        { "profile", Operation::Profile, 1, 4.5 },
+    };
+    library.fallback = { "", Operation::Profile, 1, 4.5 };
+    return library;
+}
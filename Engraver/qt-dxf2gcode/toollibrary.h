@@ -0,0 +1,57 @@
+// toollibrary.h
+// Tools with their feeds, speeds and step-downs, and which layers they cut
+
+#ifndef TOOLLIBRARY_H
+#define TOOLLIBRARY_H
+
+#include <string>
+#include <vector>
+
+enum ToolType { FlatEnd, TSlot, VBit };
+
+struct Tool {
+    int number;              // T word
+    std::string name;
+    ToolType type;
+    double diameter;         // mm; the widest part of a V-bit
+    double depth_per_pass;   // mm
+    double feed;             // mm/min
+    double plunge_feed;      // mm/min
+    double spindle_rpm;
+    double v_angle_deg;      // Only for VBit
+
+    // Radius the tool cuts at depth below the surface: a V-bit only reaches
+    // its full width once it is deep enough.
+    double cuttingRadius(double depth) const;
+};
+
+// In the order they have to be cut: engraving and pockets need the sheet
+// still in one piece, so profiles come last.
+enum class Operation { Engrave, Pocket, Profile };
+
+const char* operationName(Operation operation);
+
+// A layer whose name contains match (any case) gets this operation, tool
+// and depth. A "T<n>" in the layer name picks tool n instead.
+struct LayerRule {
+    std::string match;
+    Operation operation;
+    int tool;
+    double depth;   // mm, total
+};
+
+struct ToolLibrary {
+    std::vector<Tool> tools;
+    std::vector<LayerRule> rules;   // first match wins
+    LayerRule fallback;             // layers no rule matches
+
+    const Tool* tool(int number) const;
+    // The rule for a layer, with its tool number overridden by the name.
+    LayerRule ruleFor(const std::string& layer) const;
+};
+
+// A flat end mill, the lid T-slot cutter and a 60 degree V-bit, with
+// engrave, pocket, tslot and cut/profile layers; anything else is a profile.
+ToolLibrary defaultToolLibrary();
+
+#endif // TOOLLIBRARY_H
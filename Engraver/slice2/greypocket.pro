@@ -16,12 +16,32 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
-    clipper.engine.cpp \
-    clipper.offset.cpp \
-    clipper.rectclip.cpp \
-    main.cpp
+    layergcode.cpp \
+    layermodel.cpp \
+    layerrenderer.cpp \
+    layerstore.cpp \
+    sliceindex.cpp \
+    slicejob.cpp \
+    undercut.cpp \
+    main.cpp \
+    ../greypocket/clipper.engine.cpp \
+    ../greypocket/clipper.offset.cpp \
+    ../greypocket/clipper.rectclip.cpp \
+    ../greypocket/clipper.tiled.cpp
 
 HEADERS += \
+    layergcode.h \
+    layermodel.h \
+    layerrenderer.h \
+    layerstore.h \
+    sliceindex.h \
+    slicejob.h \
+    undercut.h \
+    ../greypocket/fixedpoint.h
+
+# Clipper2, with the parallel offset, pooled allocation and tiled booleans,
+# and the fixed-point helpers are greypocket's; one copy serves every tool.
+INCLUDEPATH += ../greypocket
 
 FORMS += \
 
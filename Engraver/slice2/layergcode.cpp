@@ -0,0 +1,48 @@
+// layergcode.cpp
+// Both passes take their Z from workZ, so a layer and its undercut are cut
+// at the same height.
+
+#include "layergcode.h"
+
+using namespace Clipper2Lib;
+
+double workZ(float mesh_z, float model_top) {
+    return static_cast<double>(mesh_z) - model_top;
+}
+
+QString layerGCode(const SlicedLayer& layer, float model_top) {
+    QString code;
+    for (const auto& path : layer.toolpath) {
+        if (path.empty()) continue;
+        code += QString("G0 X%1 Y%2\n").arg(path[0].x).arg(path[0].y);
+        code += QString("G1 Z%1 F200\n").arg(workZ(layer.region.z, model_top));
+        code += "G1 F500\n";
+        for (size_t i = 1; i < path.size(); ++i) {
+            code += QString("G1 X%1 Y%2\n").arg(path[i].x).arg(path[i].y);
+        }
+        code += QString("G1 X%1 Y%2\n").arg(path[0].x).arg(path[0].y);
+        code += QString("G0 Z%1\n").arg(clearance_mm);
+    }
+    return code;
+}
+
+QString undercutGCode(const UndercutLayer& layer, float model_top) {
+    QString code;
+    auto move = [&code](const char* g, const Point64& p) {
+        PointD mm = toMm(p);
+        code += QString("%1 X%2 Y%3\n").arg(g).arg(mm.x).arg(mm.y);
+    };
+    for (const auto& cut : layer.loops) {
+        const Path64& loop = cut.loop;
+        if (loop.empty()) continue;
+        move("G0", cut.plunge);
+        code += QString("G1 Z%1 F200\n").arg(workZ(layer.z, model_top));
+        code += "G1 F500\n";
+        if (cut.plunge != loop[0]) move("G1", loop[0]);
+        for (size_t i = 1; i < loop.size(); ++i) move("G1", loop[i]);
+        move("G1", loop[0]);
+        if (cut.plunge != loop[0]) move("G1", cut.plunge);
+        code += QString("G0 Z%1\n").arg(clearance_mm);
+    }
+    return code;
+}
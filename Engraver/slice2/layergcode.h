@@ -0,0 +1,25 @@
+// layergcode.h
+// G-code for the layer passes and the T-slot undercut passes
+
+#ifndef LAYERGCODE_H
+#define LAYERGCODE_H
+
+#include <QString>
+#include "layerstore.h"
+#include "undercut.h"
+
+// The G-code work frame has Z0 on the top of the model, the stock top, so
+// mesh heights are converted with workZ before they are written.
+const double clearance_mm = 5.0; // retract and travel height above the model top
+
+double workZ(float mesh_z, float model_top);
+
+// One layer's contours, each plunged to the layer height, closed and
+// retracted. model_top is the mesh height of the work frame's Z0.
+QString layerGCode(const SlicedLayer& layer, float model_top);
+
+// The T-slot head's loops on one layer. Each is plunged where the head clears
+// everything above, moved in at the layer height, cut, and left the same way.
+QString undercutGCode(const UndercutLayer& layer, float model_top);
+
+#endif // LAYERGCODE_H
@@ -0,0 +1,93 @@
+// layermodel.cpp
+// Every segment endpoint on a watertight mesh is shared by exactly two
+// segments, so loops fall out of a hash from endpoint to segments. Only the
+// closed loops reach Clipper, as a handful of polygons per layer instead of
+// one capsule per crossed triangle.
+
+#include "layermodel.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+struct PointHash {
+    size_t operator()(const Point64& p) const {
+        return std::hash<int64_t>()(p.x * 0x9E3779B97F4A7C15LL ^ p.y);
+    }
+};
+
+Point64 toUnits(const QVector3D& v) {
+    return Point64(std::llround(v.x() * units_per_mm), std::llround(v.y() * units_per_mm));
+}
+
+} // namespace
+
+LayerRegion buildLayerRegion(const std::vector<QVector3D>& segments, float z) {
+    LayerRegion layer;
+    layer.z = z;
+
+    std::vector<std::pair<Point64, Point64>> ends;
+    ends.reserve(segments.size() / 2);
+    for (size_t i = 0; i + 1 < segments.size(); i += 2) {
+        Point64 a = toUnits(segments[i]), b = toUnits(segments[i + 1]);
+        if (a != b) ends.emplace_back(a, b);
+    }
+
+    std::unordered_map<Point64, std::vector<size_t>, PointHash> at;
+    at.reserve(ends.size() * 2);
+    for (size_t i = 0; i < ends.size(); ++i) {
+        at[ends[i].first].push_back(i);
+        at[ends[i].second].push_back(i);
+    }
+
+    // Grows a chain from its back end until it runs out of segments (false)
+    // or comes round to its front (true).
+    std::vector<bool> used(ends.size(), false);
+    auto extend = [&](Path64& chain) {
+        for (;;) {
+            const Point64 cur = chain.back();
+            size_t next = ends.size();
+            for (size_t s : at[cur]) {
+                if (!used[s]) { next = s; break; }
+            }
+            if (next == ends.size()) return false;
+            used[next] = true;
+            Point64 pt = ends[next].first == cur ? ends[next].second : ends[next].first;
+            if (pt == chain.front()) return true;
+            chain.push_back(pt);
+        }
+    };
+
+    // A seed segment in the middle of an open chain would leave the part
+    // behind it for another chain, so an open chain is also grown backwards
+    // from the seed. It is kept apart: closing it across its gap would add
+    // an edge the mesh does not have.
+    Paths64 loops;
+    for (size_t first = 0; first < ends.size(); ++first) {
+        if (used[first]) continue;
+        used[first] = true;
+        Path64 chain{ ends[first].first, ends[first].second };
+        if (extend(chain)) {
+            if (chain.size() >= 3) loops.push_back(std::move(chain));
+        } else {
+            std::reverse(chain.begin(), chain.end());
+            extend(chain);
+            layer.open_chains.push_back(std::move(chain));
+        }
+    }
+
+    // Even-odd sorts out holes and islands whatever the loop orientation.
+    PolyTree64 tree;
+    Clipper64 clipper;
+    clipper.AddSubject(loops);
+    clipper.Execute(ClipType::Union, FillRule::EvenOdd, tree);
+    layer.polygons = PolyTreeToPaths64(tree);
+    return layer;
+}
+
+PathsD offsetLayer(const LayerRegion& layer, double delta) {
+    return toMm(InflatePaths(layer.polygons, delta * units_per_mm, JoinType::Round, EndType::Polygon));
+}
@@ -0,0 +1,28 @@
+// layermodel.h
+// Closed cross-sections built from the slice segments of one layer
+
+#ifndef LAYERMODEL_H
+#define LAYERMODEL_H
+
+#include <QVector3D>
+#include <vector>
+#include "clipper2/clipper.h"
+#include "fixedpoint.h"
+
+// The cross-section as outer contours and holes (holes reversed), with
+// islands inside holes as further outers, in fixed-point units.
+struct LayerRegion {
+    float z = 0.0f;
+    Clipper2Lib::Paths64 polygons;
+    Clipper2Lib::Paths64 open_chains;   // chains that did not close, left out of polygons; the mesh is not watertight here
+};
+
+// Joins segment endpoints into loops and resolves them with an even-odd
+// union into a PolyTree64, so loop orientation in the mesh does not matter.
+// segments holds pairs of points as produced by sliceLayer.
+LayerRegion buildLayerRegion(const std::vector<QVector3D>& segments, float z);
+
+// One polygon offset of the whole region, in mm (negative shrinks it).
+Clipper2Lib::PathsD offsetLayer(const LayerRegion& layer, double delta);
+
+#endif // LAYERMODEL_H
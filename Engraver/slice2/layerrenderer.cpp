@@ -0,0 +1,196 @@
+// layerrenderer.cpp
+// The buffer grows by doubling, so adding layers one by one costs an
+// amortised single upload of each vertex.
+
+#include "layerrenderer.h"
+#include <QOpenGLContext>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+
+// Blue -> green -> red over t in [0, 1].
+void layerColour(float t, unsigned char rgba[4]) {
+    float r = std::min(1.0f, std::max(0.0f, 2.0f * t - 1.0f));
+    float b = std::min(1.0f, std::max(0.0f, 1.0f - 2.0f * t));
+    float g = 1.0f - r - b;
+    rgba[0] = static_cast<unsigned char>(55 + 200 * r);
+    rgba[1] = static_cast<unsigned char>(55 + 200 * g);
+    rgba[2] = static_cast<unsigned char>(55 + 200 * b);
+    rgba[3] = 255;
+}
+
+// Attribute pointers are byte offsets into the bound buffer.
+const void* bufferOffset(size_t bytes) {
+    return reinterpret_cast<const void*>(bytes);
+}
+
+} // namespace
+
+void LayerRenderer::initialize() {
+    vbo_.create();
+    vbo_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    highlight_.create();
+    highlight_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    capacity_ = uploaded_ = 0;
+    // GL 1.4; without it each range gets its own glDrawArrays.
+    multiDraw_ = reinterpret_cast<MultiDrawArrays>(QOpenGLContext::currentContext()->getProcAddress("glMultiDrawArrays"));
+}
+
+void LayerRenderer::reset(size_t layer_count) {
+    vertices_.clear();
+    first_.assign(layer_count, 0);
+    count_.assign(layer_count, -1);
+    uploaded_ = 0;
+    added_ = 0;
+}
+
+void LayerRenderer::addLayer(size_t index, const std::vector<QVector3D>& segments) {
+    if (index >= count_.size() || count_[index] >= 0) return;
+    Vertex v;
+    layerColour(count_.size() > 1 ? float(index) / float(count_.size() - 1) : 0.0f, v.rgba);
+    first_[index] = static_cast<GLint>(vertices_.size());
+    count_[index] = static_cast<GLsizei>(segments.size() & ~size_t(1));
+    for (GLsizei i = 0; i < count_[index]; ++i) {
+        v.x = segments[i].x();
+        v.y = segments[i].y();
+        v.z = segments[i].z();
+        vertices_.push_back(v);
+    }
+    ++added_;
+}
+
+// Once every layer is in, lays them out in index order so that any range of
+// layers is one contiguous glDrawArrays from then on.
+void LayerRenderer::compact() {
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertices_.size());
+    for (size_t i = 0; i < count_.size(); ++i) {
+        GLint first = static_cast<GLint>(ordered.size());
+        ordered.insert(ordered.end(), vertices_.begin() + first_[i], vertices_.begin() + first_[i] + count_[i]);
+        first_[i] = first;
+    }
+    vertices_.swap(ordered);
+    uploaded_ = 0;
+}
+
+void LayerRenderer::upload() {
+    if (!count_.empty() && added_ == count_.size()) {
+        bool inOrder = true;
+        for (size_t i = 1; i < count_.size() && inOrder; ++i) inOrder = first_[i] == first_[i - 1] + count_[i - 1];
+        if (!inOrder) compact();
+    }
+    if (uploaded_ == vertices_.size()) return;
+
+    vbo_.bind();
+    if (vertices_.size() > capacity_) {
+        capacity_ = std::max({ vertices_.size(), 2 * capacity_, size_t(4096) });
+        vbo_.allocate(static_cast<int>(capacity_ * sizeof(Vertex)));
+        uploaded_ = 0;
+    }
+    vbo_.write(static_cast<int>(uploaded_ * sizeof(Vertex)), vertices_.data() + uploaded_,
+               static_cast<int>((vertices_.size() - uploaded_) * sizeof(Vertex)));
+    vbo_.release();
+    uploaded_ = vertices_.size();
+}
+
+void LayerRenderer::draw(size_t first, size_t last) {
+    if (count_.empty() || uploaded_ == 0) return;
+    last = std::min(last, count_.size() - 1);
+
+    // Merge layers that follow each other in the buffer into one range.
+    std::vector<GLint> starts;
+    std::vector<GLsizei> counts;
+    for (size_t i = first; i <= last; ++i) {
+        if (count_[i] <= 0 || size_t(first_[i] + count_[i]) > uploaded_) continue;
+        if (!starts.empty() && starts.back() + counts.back() == first_[i]) {
+            counts.back() += count_[i];
+        } else {
+            starts.push_back(first_[i]);
+            counts.push_back(count_[i]);
+        }
+    }
+    if (!starts.empty()) drawArrays(vbo_, starts.data(), counts.data(), static_cast<GLsizei>(starts.size()), true);
+}
+
+void LayerRenderer::setHighlight(const std::vector<QVector3D>& segments) {
+    highlightVertices_.clear();
+    Vertex v = { 0, 0, 0, { 255, 255, 255, 255 } };
+    for (const auto& p : segments) {
+        v.x = p.x();
+        v.y = p.y();
+        v.z = p.z();
+        highlightVertices_.push_back(v);
+    }
+    highlightDirty_ = true;
+}
+
+void LayerRenderer::drawHighlight(float r, float g, float b) {
+    if (highlightDirty_) {
+        highlight_.bind();
+        highlight_.allocate(highlightVertices_.data(), static_cast<int>(highlightVertices_.size() * sizeof(Vertex)));
+        highlight_.release();
+        highlightCount_ = highlightVertices_.size() & ~size_t(1);
+        highlightDirty_ = false;
+    }
+    if (highlightCount_ == 0) return;
+    GLint start = 0;
+    GLsizei count = static_cast<GLsizei>(highlightCount_);
+    glColor3f(r, g, b);
+    drawArrays(highlight_, &start, &count, 1, false);
+}
+
+void LayerRenderer::drawArrays(QOpenGLBuffer& buffer, const GLint* first, const GLsizei* count, GLsizei ranges,
+                               bool colours) {
+    buffer.bind();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), bufferOffset(offsetof(Vertex, x)));
+    if (colours) {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), bufferOffset(offsetof(Vertex, rgba)));
+    }
+    if (ranges == 1) {
+        glDrawArrays(GL_LINES, first[0], count[0]);
+    } else if (multiDraw_) {
+        multiDraw_(GL_LINES, first, count, ranges);
+    } else {
+        for (GLsizei i = 0; i < ranges; ++i) glDrawArrays(GL_LINES, first[i], count[i]);
+    }
+    if (colours) glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    buffer.release();
+}
+
+void OrbitCamera::fit(const QVector3D& lo, const QVector3D& hi) {
+    target = (lo + hi) * 0.5f;
+    distance = std::max(10.0f, 1.5f * (hi - lo).length());
+}
+
+void OrbitCamera::drag(const QPoint& pos) {
+    QPoint delta = pos - last;
+    last = pos;
+    yaw -= 0.5f * delta.x();
+    pitch = std::max(-89.0f, std::min(89.0f, pitch + 0.5f * delta.y()));
+}
+
+void OrbitCamera::zoom(int wheel_delta) {
+    // One notch (120) moves 15% closer or further.
+    distance = std::max(1.0f, distance * std::pow(0.85f, wheel_delta / 120.0f));
+}
+
+QMatrix4x4 OrbitCamera::projection(float aspect) const {
+    QMatrix4x4 m;
+    m.perspective(45.0f, aspect, distance * 0.01f, distance * 10.0f);
+    return m;
+}
+
+QMatrix4x4 OrbitCamera::view() const {
+    const float deg = 3.14159265f / 180.0f;
+    QVector3D eye = target + distance * QVector3D(std::cos(pitch * deg) * std::cos(yaw * deg),
+                                                  std::cos(pitch * deg) * std::sin(yaw * deg),
+                                                  std::sin(pitch * deg));
+    QMatrix4x4 m;
+    m.lookAt(eye, target, QVector3D(0, 0, 1));
+    return m;
+}
@@ -0,0 +1,86 @@
+// layerrenderer.h
+// Sliced layers kept in a vertex buffer, drawn by layer range, plus an orbit camera
+
+#ifndef LAYERRENDERER_H
+#define LAYERRENDERER_H
+
+#include <QMatrix4x4>
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QPoint>
+#include <QVector3D>
+#include <vector>
+
+// Each layer's segments go into the vertex buffer once, when the layer is
+// added; frames after that only issue draw calls. Layers are coloured by
+// index, blue at the bottom to red at the top. Everything is fixed-function
+// GL_LINES with client-state arrays, which Mesa's software rasterizer runs
+// without any shader compiles.
+class LayerRenderer {
+public:
+    // Needs the GL context current, like all the methods below that touch GL.
+    void initialize();
+
+    // Drops every layer; colours are spread over layer_count layers.
+    void reset(size_t layer_count);
+    bool hasLayer(size_t index) const { return index < count_.size() && count_[index] >= 0; }
+
+    // Segment pairs, as the slicer emits them. Only copied here; upload()
+    // sends everything added since the last call in one buffer write.
+    void addLayer(size_t index, const std::vector<QVector3D>& segments);
+    void upload();
+
+    // Draws layers first..last. Layers that sit next to each other in the
+    // buffer merge into one range, so layers added in order draw with a
+    // single glDrawArrays and the rest with one glMultiDrawArrays.
+    void draw(size_t first, size_t last);
+
+    // A single set of segments in one colour over the layers (the live slice).
+    void setHighlight(const std::vector<QVector3D>& segments);
+    void drawHighlight(float r, float g, float b);
+
+private:
+    struct Vertex {
+        float x, y, z;
+        unsigned char rgba[4];
+    };
+    typedef void (QOPENGLF_APIENTRYP MultiDrawArrays)(GLenum, const GLint*, const GLsizei*, GLsizei);
+
+    void compact();
+    void drawArrays(QOpenGLBuffer& buffer, const GLint* first, const GLsizei* count, GLsizei ranges, bool colours);
+
+    QOpenGLBuffer vbo_{ QOpenGLBuffer::VertexBuffer };
+    QOpenGLBuffer highlight_{ QOpenGLBuffer::VertexBuffer };
+    MultiDrawArrays multiDraw_ = nullptr;
+    std::vector<Vertex> vertices_;   // mirror of the buffer, for growing and compacting it
+    std::vector<GLint> first_;       // per layer, in vertices
+    std::vector<GLsizei> count_;     // per layer, -1 until added
+    size_t uploaded_ = 0;            // vertices already in vbo_
+    size_t capacity_ = 0;            // vertices vbo_ has room for
+    size_t added_ = 0;               // layers added since reset
+    size_t highlightCount_ = 0;
+    bool highlightDirty_ = false;
+    std::vector<Vertex> highlightVertices_;
+};
+
+// Turntable camera around a target: drag to orbit, wheel to zoom.
+struct OrbitCamera {
+    QVector3D target;
+    float distance = 200.0f;
+    float yaw = -30.0f;     // degrees around Z
+    float pitch = 35.0f;    // degrees above the XY plane
+
+    // Frames a bounding box.
+    void fit(const QVector3D& lo, const QVector3D& hi);
+
+    void press(const QPoint& pos) { last = pos; }
+    void drag(const QPoint& pos);
+    void zoom(int wheel_delta);
+
+    QMatrix4x4 projection(float aspect) const;
+    QMatrix4x4 view() const;
+
+    QPoint last;
+};
+
+#endif // LAYERRENDERER_H
@@ -0,0 +1,66 @@
+// layerstore.cpp
+// Both classes only hold their lock for copies and file writes, never while
+// a layer is being sliced.
+
+#include "layerstore.h"
+
+void LayerStore::reset(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    layers_.assign(count, SlicedLayer());
+    done_.assign(count, false);
+    finished_ = 0;
+    ++version_;
+}
+
+void LayerStore::publish(size_t index, SlicedLayer layer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index >= layers_.size() || done_[index]) return;
+    layers_[index] = std::move(layer);
+    done_[index] = true;
+    ++finished_;
+    ++version_;
+}
+
+size_t LayerStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return layers_.size();
+}
+
+size_t LayerStore::finished() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return finished_;
+}
+
+LayerRegion LayerStore::region(size_t index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index < layers_.size() ? layers_[index].region : LayerRegion();
+}
+
+bool GCodeStream::open(const QString& path, const QString& header) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_.isOpen()) file_.close();
+    file_.setFileName(path);
+    next_ = 0;
+    waiting_.clear();
+    if (!file_.open(QIODevice::WriteOnly)) return false;
+    file_.write(header.toUtf8());
+    return true;
+}
+
+void GCodeStream::put(size_t index, const QString& code) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.isOpen()) return;
+    waiting_[index] = code;
+    for (auto it = waiting_.find(next_); it != waiting_.end(); it = waiting_.find(next_)) {
+        file_.write(it->second.toUtf8());
+        waiting_.erase(it);
+        ++next_;
+    }
+}
+
+void GCodeStream::close(const QString& footer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.isOpen()) return;
+    file_.write(footer.toUtf8());
+    file_.close();
+}
@@ -0,0 +1,66 @@
+// layerstore.h
+// Finished layers shared between the slicing workers, the view and the G-code file
+
+#ifndef LAYERSTORE_H
+#define LAYERSTORE_H
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "clipper2/clipper.h"
+#include "layermodel.h"
+
+struct SlicedLayer {
+    LayerRegion region;
+    Clipper2Lib::PathsD toolpath;
+};
+
+// Workers publish layers in any order; readers take copies under the lock.
+// version() changes on every publish so the view can poll it cheaply.
+class LayerStore {
+public:
+    void reset(size_t count);
+    void publish(size_t index, SlicedLayer layer);
+
+    size_t size() const;
+    size_t finished() const;
+    // A copy of one layer's cross-section; empty until it is published.
+    LayerRegion region(size_t index) const;
+    unsigned version() const { return version_; }
+
+    // Calls fn(index, layer) for every finished layer, under the lock.
+    template <typename Fn>
+    void forEachFinished(Fn fn) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < layers_.size(); ++i) {
+            if (done_[i]) fn(i, layers_[i]);
+        }
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<SlicedLayer> layers_;
+    std::vector<bool> done_;
+    size_t finished_ = 0;
+    std::atomic<unsigned> version_{ 0 };
+};
+
+// Writes per-layer G-code in layer order as soon as each layer and all the
+// ones before it are done; layers that finish early wait in memory.
+class GCodeStream {
+public:
+    bool open(const QString& path, const QString& header);
+    void put(size_t index, const QString& code);
+    void close(const QString& footer);
+
+private:
+    std::mutex mutex_;
+    QFile file_;
+    size_t next_ = 0;
+    std::map<size_t, QString> waiting_;
+};
+
+#endif // LAYERSTORE_H
@@ -3,7 +3,11 @@
 
 #include <QApplication>
 #include <QOpenGLWidget>
+#include <QSlider>
+#include <QVBoxLayout>
 #include <QFileDialog>
+#include <QMouseEvent>
+#include <QWheelEvent>
 #include <QVector3D>
 #include <QSurfaceFormat>
 #include <QTimer>
@@ -11,17 +15,21 @@
 #include <vector>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
 #include <QFile>
 #include <QPainterPath>
 #include <QPolygonF>
 #include "clipper2/clipper.h"
+#include "layergcode.h"
+#include "layermodel.h"
+#include "layerrenderer.h"
+#include "layerstore.h"
+#include "sliceindex.h"
+#include "slicejob.h"
+#include "undercut.h"
 
 using namespace Clipper2Lib;
 
-struct Triangle {
-    QVector3D v0, v1, v2;
-};
-
 enum ToolType { TSlot, VBit };
 
 struct Tool {
@@ -29,7 +37,6 @@ struct Tool {
     double shaft_diameter = 6.0;
     double head_diameter = 10.0;
     double v_angle_deg = 60.0; // used for V-bit
-    double cut_depth = -5.0;
 };
 
 std::vector<Triangle> loadSTL(const QString& path) {
@@ -57,122 +64,204 @@ std::vector<Triangle> loadSTL(const QString& path) {
     return tris;
 }
 
-std::vector<QVector3D> sliceLayer(const std::vector<Triangle>& tris, float z) {
+const QString gcode_header = QString("G21\nG90\nG0 Z%1\nT1 M6\n").arg(clearance_mm);
+const QString gcode_footer = "M30\n";
+
+// A layer's toolpath loops as segment pairs at its height, for the renderer.
+std::vector<QVector3D> loopSegments(const PathsD& loops, float z) {
     std::vector<QVector3D> lines;
-    for (const auto& tri : tris) {
-        std::vector<QVector3D> pts;
-        auto test = [&](QVector3D a, QVector3D b) {
-            if ((a.z() < z && b.z() > z) || (a.z() > z && b.z() < z)) {
-                float t = (z - a.z()) / (b.z() - a.z());
-                pts.push_back(a + t * (b - a));
-            }
-        };
-        test(tri.v0, tri.v1);
-        test(tri.v1, tri.v2);
-        test(tri.v2, tri.v0);
-        if (pts.size() == 2) {
-            lines.push_back(pts[0]);
-            lines.push_back(pts[1]);
+    for (const auto& loop : loops) {
+        for (size_t i = 0; i < loop.size(); ++i) {
+            const PointD& a = loop[i];
+            const PointD& b = loop[(i + 1) % loop.size()];
+            lines.push_back(QVector3D(float(a.x), float(a.y), z));
+            lines.push_back(QVector3D(float(b.x), float(b.y), z));
         }
     }
-    qDebug() << "test";
     return lines;
 }
 
-QString generateGCodeWithClipper(const std::vector<std::vector<QVector3D>>& allLayers, const Tool& tool) {
-    QString code = "G21\nG90\nG0 Z5\nT1 M6\n";
-
-    for (const auto& layer : allLayers) {
-        if (layer.empty()) continue;
-
-        // Convert line segments to Clipper Path
-        PathsD paths;
-        for (size_t i = 0; i + 1 < layer.size(); i += 2) {
-            PathD path;
-            path.push_back(PointD(layer[i].x(), layer[i].y()));
-            path.push_back(PointD(layer[i + 1].x(), layer[i + 1].y()));
-            paths.push_back(path);
-        }
-
-        // Optional: unify/join paths, offset for tool radius if needed
-        auto offsetPaths = InflatePaths(paths, -tool.shaft_diameter / 2.0, JoinType::Round, EndType::Round);
-
-        code += QString("G1 Z%1 F200\n").arg(tool.cut_depth);
-        for (const auto& path : offsetPaths) {
-            if (path.empty()) continue;
-            code += QString("G0 X%1 Y%2\n").arg(path[0].x).arg(path[0].y);
-            code += "G1 F500\n";
-            for (size_t i = 1; i < path.size(); ++i) {
-                code += QString("G1 X%1 Y%2\n").arg(path[i].x).arg(path[i].y);
-            }
-            code += "G0 Z5\n";
-        }
-    }
-    code += "M30\n";
-    return code;
-}
-
 class SlicerWidget : public QOpenGLWidget {
 public:
     std::vector<Triangle> model;
-    std::vector<std::vector<QVector3D>> layers;
+    SliceIndex index;
+    std::vector<float> layerZ;
+    LayerStore store;
+    GCodeStream gcodeOut;
+    SliceJob job;
+    std::vector<QVector3D> viewSegments;   // the slice shown, at viewZ
+    float viewZ = 0.0f;
     Tool tool;
     float layerHeight = 1.0f;
     float maxZ = 0.0f;
 
+    SlicerWidget() {
+        // Workers never touch the widget; the GUI thread polls the store and
+        // repaints when layers have come in.
+        QTimer* poll = new QTimer(this);
+        QObject::connect(poll, &QTimer::timeout, [this]() {
+            if (store.version() != shownVersion) update();
+        });
+        poll->start(50);
+    }
+
+    ~SlicerWidget() override {
+        job.cancel();
+    }
+
     void loadModel(const QString& path) {
+        job.cancel();
         model = loadSTL(path);
-
-        maxZ = 0.0f;
-        for (const auto& tri : model) {
-            maxZ = std::max({ maxZ, tri.v0.z(), tri.v1.z(), tri.v2.z() });
+        index.build(model);
+        maxZ = model.empty() ? 0.0f : index.maxZ();
+        QVector3D lo(0, 0, 0), hi(0, 0, 0);
+        if (!model.empty()) {
+            lo = hi = model[0].v0;
+            for (const auto& tri : model) {
+                for (const QVector3D& v : { tri.v0, tri.v1, tri.v2 }) {
+                    lo = QVector3D(std::min(lo.x(), v.x()), std::min(lo.y(), v.y()), std::min(lo.z(), v.z()));
+                    hi = QVector3D(std::max(hi.x(), v.x()), std::max(hi.y(), v.y()), std::max(hi.z(), v.z()));
+                }
+            }
+            camera.fit(lo, hi);
         }
-
-        layers.clear();
-        for (float z = 0.0f; z <= maxZ; z += layerHeight) {
-            layers.push_back(sliceLayer(model, z));
+        // Layers are sliced and offset in fixed point, exact only up to a span.
+        if (!withinExactExtent(hi.x() - lo.x(), hi.y() - lo.y())) {
+            qDebug() << "The model spans" << hi.x() - lo.x() << "x" << hi.y() - lo.y() << "mm; past"
+                     << exact_extent_mm << "mm the layer offsets may misjudge where contours cross";
         }
 
-        QString gcode = generateGCodeWithClipper(layers, tool);
-        QFile file("output.gcode");
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write(gcode.toUtf8());
-            file.close();
-        }
+        layerZ.clear();
+        for (float z = 0.0f; z <= maxZ; z += layerHeight) layerZ.push_back(z);
+        store.reset(layerZ.size());
+        renderer.reset(layerZ.size());
+        if (!gcodeOut.open("output.gcode", gcode_header)) qDebug() << "Cannot write output.gcode";
+
+        Tool cutter = tool;
+        // Room around the part for the head to come down outside it.
+        double margin = cutter.head_diameter + 1.0;
+        Rect64 stock(toUnits(lo.x() - margin), toUnits(lo.y() - margin), toUnits(hi.x() + margin), toUnits(hi.y() + margin));
+        job.start(layerZ.size(),
+                  [this, cutter](size_t i) {
+                      SlicedLayer layer;
+                      layer.region = buildLayerRegion(index.slice(layerZ[i]), layerZ[i]);
+                      if (!layer.region.open_chains.empty()) {
+                          qDebug() << "Layer" << i << "has" << layer.region.open_chains.size() << "open chains; the mesh is not watertight";
+                      }
+                      // One offset of the closed cross-section for the tool radius.
+                      layer.toolpath = offsetLayer(layer.region, -cutter.shaft_diameter / 2.0);
+                      return layer;
+                  },
+                  [top = maxZ](const SlicedLayer& layer) { return layerGCode(layer, top); },
+                  store, gcodeOut, gcode_footer,
+                  [this, cutter, stock, top = maxZ](const std::atomic<bool>& stop) {
+                      // Undercuts need every layer above, so they are swept
+                      // top down once all the layers are in.
+                      QString code;
+                      if (cutter.type != TSlot || cutter.head_diameter <= cutter.shaft_diameter) return code;
+                      UndercutSweep sweep(cutter.shaft_diameter, cutter.head_diameter, stock);
+                      size_t passes = 0;
+                      for (size_t i = store.size(); i-- > 0 && !stop;) {
+                          UndercutLayer under = sweep.step(store.region(i));
+                          if (under.skipped_loops) {
+                              qDebug() << "Layer" << i << ":" << under.skipped_loops << "undercut loops have nowhere to plunge the head";
+                          }
+                          if (under.loops.empty()) continue;
+                          code += undercutGCode(under, top);
+                          ++passes;
+                      }
+                      qDebug() << "T-slot undercuts on" << passes << "layers";
+                      return code;
+                  });
+        showHeight(0.0f);
+    }
+
+    // Slices straight from the index, so any height shows without waiting.
+    // Finished toolpaths are drawn up to this height.
+    void showHeight(float z) {
+        viewZ = z;
+        viewSegments = index.slice(z);
+        renderer.setHighlight(viewSegments);
         update();
     }
 
 protected:
     void initializeGL() override {
         glClearColor(0.1f, 0.1f, 0.1f, 1);
+        renderer.initialize();
     }
     void resizeGL(int w, int h) override {
         glViewport(0, 0, w, h);
+        aspect = float(w) / float(h ? h : 1);
     }
     void paintGL() override {
+        // Only layers that came in since the last frame are converted and
+        // uploaded; the rest are already in the vertex buffer.
+        if (store.version() != shownVersion) {
+            shownVersion = store.version();
+            store.forEachFinished([this](size_t i, const SlicedLayer& layer) {
+                if (!renderer.hasLayer(i)) renderer.addLayer(i, loopSegments(layer.toolpath, layerZ[i]));
+            });
+        }
+        renderer.upload();
+
         glClear(GL_COLOR_BUFFER_BIT);
-        glBegin(GL_LINES);
-        glColor3f(0, 1, 0);
-        if (!layers.empty()) {
-            for (const auto& v : layers.front()) {
-                glVertex2f(v.x() / 100.0f, v.y() / 100.0f);
-            }
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(camera.projection(aspect).constData());
+        glMatrixMode(GL_MODELVIEW);
+        glLoadMatrixf(camera.view().constData());
+
+        size_t top = std::upper_bound(layerZ.begin(), layerZ.end(), viewZ) - layerZ.begin();
+        if (top > 0) renderer.draw(0, top - 1);
+        renderer.drawHighlight(0, 1, 0);
+    }
+
+    void mousePressEvent(QMouseEvent* event) override {
+        camera.press(event->pos());
+    }
+    void mouseMoveEvent(QMouseEvent* event) override {
+        if (event->buttons() & Qt::LeftButton) {
+            camera.drag(event->pos());
+            update();
         }
-        glEnd();
     }
+    void wheelEvent(QWheelEvent* event) override {
+        camera.zoom(event->angleDelta().y());
+        update();
+    }
+
+private:
+    LayerRenderer renderer;
+    OrbitCamera camera;
+    float aspect = 1.0f;
+    unsigned shownVersion = 0;
 };
 
 int main(int argc, char** argv) {
     QApplication app(argc, argv);
 
+    QWidget* window = new QWidget;
+    QVBoxLayout* layout = new QVBoxLayout(window);
     SlicerWidget* slicer = new SlicerWidget;
-    slicer->resize(800, 600);
-    slicer->tool = { TSlot, 6.0, 10.0, 60.0, -5.0 }; // Default tool is T-slot
-    slicer->show();
+    slicer->tool = { TSlot, 6.0, 10.0, 60.0 }; // Default tool is T-slot
+    QSlider* heightSlider = new QSlider(Qt::Horizontal);
+    heightSlider->setRange(0, 1000);
+    layout->addWidget(slicer, 1);
+    layout->addWidget(heightSlider);
+    window->resize(800, 600);
+    window->show();
+
+    QObject::connect(heightSlider, &QSlider::valueChanged, [slicer](int value) {
+        float lo = slicer->index.minZ(), hi = slicer->index.maxZ();
+        slicer->showHeight(lo + (hi - lo) * value / 1000.0f);
+    });
 
     QTimer::singleShot(500, [&] {
         QString file = QFileDialog::getOpenFileName(nullptr, "Load STL", "", "STL Files (*.stl)");
-        if (!file.isEmpty()) slicer->loadModel(file);
+        if (!file.isEmpty()) {
+            slicer->loadModel(file);
+            heightSlider->setValue(0);
+        }
     });
 
     return app.exec();
@@ -0,0 +1,98 @@
+// sliceindex.cpp
+// Each node splits at the median triangle mid-height. Triangles spanning the
+// split stay in the node, sorted both ways, so a query only scans a list until
+// the first triangle that no longer reaches z.
+
+#include "sliceindex.h"
+#include <algorithm>
+#include <utility>
+
+void sliceTriangle(const Triangle& tri, float z, std::vector<QVector3D>& lines) {
+    QVector3D pts[2];
+    int count = 0;
+    auto test = [&](QVector3D a, QVector3D b) {
+        if ((a.z() < z) == (b.z() < z)) return;
+        if (a.z() > b.z()) std::swap(a, b);
+        float t = (z - a.z()) / (b.z() - a.z());
+        if (count < 2) pts[count] = a + t * (b - a);
+        ++count;
+    };
+    test(tri.v0, tri.v1);
+    test(tri.v1, tri.v2);
+    test(tri.v2, tri.v0);
+    if (count == 2) {
+        lines.push_back(pts[0]);
+        lines.push_back(pts[1]);
+    }
+}
+
+void SliceIndex::build(const std::vector<Triangle>& tris) {
+    tris_ = &tris;
+    lo_.resize(tris.size());
+    hi_.resize(tris.size());
+    nodes_.clear();
+    minZ_ = maxZ_ = 0.0f;
+
+    std::vector<uint32_t> items(tris.size());
+    for (size_t i = 0; i < tris.size(); ++i) {
+        const Triangle& t = tris[i];
+        lo_[i] = std::min({ t.v0.z(), t.v1.z(), t.v2.z() });
+        hi_[i] = std::max({ t.v0.z(), t.v1.z(), t.v2.z() });
+        items[i] = static_cast<uint32_t>(i);
+        minZ_ = i ? std::min(minZ_, lo_[i]) : lo_[i];
+        maxZ_ = i ? std::max(maxZ_, hi_[i]) : hi_[i];
+    }
+    root_ = items.empty() ? -1 : buildNode(items);
+}
+
+int SliceIndex::buildNode(std::vector<uint32_t>& items) {
+    auto mid = [&](uint32_t i) { return 0.5f * (lo_[i] + hi_[i]); };
+    auto median = items.begin() + items.size() / 2;
+    std::nth_element(items.begin(), median, items.end(), [&](uint32_t a, uint32_t b) { return mid(a) < mid(b); });
+    float centre = mid(*median);
+
+    // The median triangle spans its own mid-height, so the node is never
+    // empty and both sides are strictly smaller.
+    std::vector<uint32_t> below, above, here;
+    for (uint32_t i : items) {
+        if (hi_[i] < centre) below.push_back(i);
+        else if (lo_[i] > centre) above.push_back(i);
+        else here.push_back(i);
+    }
+    items.clear();
+    items.shrink_to_fit();
+
+    int index = static_cast<int>(nodes_.size());
+    nodes_.emplace_back();
+    Node node;
+    node.centre = centre;
+    node.byMin = here;
+    std::sort(node.byMin.begin(), node.byMin.end(), [&](uint32_t a, uint32_t b) { return lo_[a] < lo_[b]; });
+    node.byMax = std::move(here);
+    std::sort(node.byMax.begin(), node.byMax.end(), [&](uint32_t a, uint32_t b) { return hi_[a] > hi_[b]; });
+    if (!below.empty()) node.left = buildNode(below);
+    if (!above.empty()) node.right = buildNode(above);
+    nodes_[index] = std::move(node);
+    return index;
+}
+
+std::vector<QVector3D> SliceIndex::slice(float z) const {
+    std::vector<QVector3D> lines;
+    for (int n = root_; n >= 0;) {
+        const Node& node = nodes_[n];
+        if (z < node.centre) {
+            for (uint32_t i : node.byMin) {
+                if (lo_[i] > z) break;
+                sliceTriangle((*tris_)[i], z, lines);
+            }
+            n = node.left;
+        } else {
+            for (uint32_t i : node.byMax) {
+                if (hi_[i] < z) break;
+                sliceTriangle((*tris_)[i], z, lines);
+            }
+            n = node.right;
+        }
+    }
+    return lines;
+}
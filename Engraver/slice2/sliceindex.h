@@ -0,0 +1,51 @@
+// sliceindex.h
+// Z-interval tree over the mesh triangles for slicing at any height
+
+#ifndef SLICEINDEX_H
+#define SLICEINDEX_H
+
+#include <QVector3D>
+#include <cstdint>
+#include <vector>
+
+struct Triangle {
+    QVector3D v0, v1, v2;
+};
+
+// Appends the crossing segment of tri with the plane at z, if there is one.
+// A vertex on the plane counts as above it, so every triangle gives zero or
+// two crossings. Each edge is interpolated from its lower end so the two
+// triangles sharing it produce the very same point.
+void sliceTriangle(const Triangle& tri, float z, std::vector<QVector3D>& lines);
+
+// Centred interval tree over the triangles' Z extents. A query visits one
+// node per tree level and, at each, only the triangles that span z, so the
+// cost is O(log n + triangles crossing z).
+class SliceIndex {
+public:
+    void build(const std::vector<Triangle>& tris);
+
+    // Segment pairs of the plane at z, as sliceTriangle emits them.
+    std::vector<QVector3D> slice(float z) const;
+
+    float minZ() const { return minZ_; }
+    float maxZ() const { return maxZ_; }
+
+private:
+    struct Node {
+        float centre = 0.0f;
+        int left = -1, right = -1;
+        std::vector<uint32_t> byMin;   // spanning centre, ascending min Z
+        std::vector<uint32_t> byMax;   // spanning centre, descending max Z
+    };
+
+    int buildNode(std::vector<uint32_t>& items);
+
+    const std::vector<Triangle>* tris_ = nullptr;
+    std::vector<float> lo_, hi_;   // Z extent per triangle
+    std::vector<Node> nodes_;
+    int root_ = -1;
+    float minZ_ = 0.0f, maxZ_ = 0.0f;
+};
+
+#endif // SLICEINDEX_H
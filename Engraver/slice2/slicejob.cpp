@@ -0,0 +1,38 @@
+// slicejob.cpp
+// The last worker to run out of layers runs the finish step and closes the
+// G-code file, so the footer goes in exactly once and only after every layer.
+
+#include "slicejob.h"
+#include <algorithm>
+
+void SliceJob::start(size_t layer_count, MakeLayer make, LayerCode code, LayerStore& store, GCodeStream& out,
+                     const QString& footer, Finish finish, unsigned threads) {
+    cancel();
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, layer_count)));
+    stop_ = false;
+    next_ = 0;
+    active_ = threads;
+
+    auto worker = [this, layer_count, make, code, &store, &out, footer, finish]() {
+        for (size_t i = next_++; i < layer_count && !stop_; i = next_++) {
+            SlicedLayer layer = make(i);
+            out.put(i, code(layer));
+            store.publish(i, std::move(layer));
+        }
+        if (--active_ == 0) {
+            if (finish && !stop_) {
+                QString tail = finish(stop_);
+                if (!stop_) out.put(layer_count, tail);
+            }
+            out.close(stop_ ? QString() : footer);
+        }
+    };
+    for (unsigned t = 0; t < threads; ++t) workers_.emplace_back(worker);
+}
+
+void SliceJob::cancel() {
+    stop_ = true;
+    for (auto& th : workers_) th.join();
+    workers_.clear();
+}
@@ -0,0 +1,40 @@
+// slicejob.h
+// Slices and offsets layers on worker threads, off the GUI thread
+
+#ifndef SLICEJOB_H
+#define SLICEJOB_H
+
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "layerstore.h"
+
+// Workers claim layers bottom first, so the first layers show up (and reach
+// the G-code file) early. Everything passed to start() must outlive the job;
+// cancel() or the destructor stops and joins the workers.
+class SliceJob {
+public:
+    using MakeLayer = std::function<SlicedLayer(size_t index)>;
+    using LayerCode = std::function<QString(const SlicedLayer& layer)>;
+    // Runs once every layer is done, on the last worker; its code goes in
+    // after the layers and before the footer. It should return early once
+    // stop is set.
+    using Finish = std::function<QString(const std::atomic<bool>& stop)>;
+
+    ~SliceJob() { cancel(); }
+
+    void start(size_t layer_count, MakeLayer make, LayerCode code, LayerStore& store, GCodeStream& out,
+               const QString& footer, Finish finish = nullptr, unsigned threads = 0);
+    void cancel();
+    bool running() const { return active_ > 0; }
+
+private:
+    std::vector<std::thread> workers_;
+    std::atomic<bool> stop_{ false };
+    std::atomic<size_t> next_{ 0 };
+    std::atomic<unsigned> active_{ 0 };
+};
+
+#endif // SLICEJOB_H
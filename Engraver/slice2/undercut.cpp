@@ -0,0 +1,188 @@
+// undercut.cpp
+// The running unions only ever grow by one layer per step; everything else
+// is per layer.
+
+#include "undercut.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+// Slivers thinner than this are offset rounding where the head only touches
+// the wall above, not an undercut.
+const double sliver_width = 0.05 * units_per_mm;
+
+// Lead-ins tried per loop, nearest first, before giving up on it.
+const size_t max_lead_in_tries = 16;
+
+// The sweep runs alone once every layer is sliced, so its offsets may use
+// every core (0 = one thread per core).
+const unsigned offset_threads = 0;
+
+struct Component {
+    Paths64 paths;   // outer with its holes
+    Paths64 entry;   // the part the whole head can come down into
+};
+
+// Inside or on the boundary of a region whose paths do not overlap.
+bool inRegion(const Point64& p, const Paths64& region) {
+    int inside = 0;
+    for (const auto& path : region) {
+        PointInPolygonResult r = PointInPolygon(p, path);
+        if (r == PointInPolygonResult::IsOn) return true;
+        if (r == PointInPolygonResult::IsInside) ++inside;
+    }
+    return inside % 2 == 1;
+}
+
+double pathLength(const Path64& path) {
+    double length = 0.0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        length += std::sqrt(double(DistanceSqr(path[i - 1], path[i])));
+    }
+    return length;
+}
+
+// True when the straight move a -> b stays inside region.
+bool segmentInside(const Point64& a, const Point64& b, const Paths64& region) {
+    Clipper64 clipper;
+    clipper.AddOpenSubject({ Path64{ a, b } });
+    clipper.AddClip(region);
+    Paths64 closed, open;
+    clipper.Execute(ClipType::Intersection, FillRule::NonZero, closed, open);
+    double inside = 0.0;
+    for (const auto& piece : open) inside += pathLength(piece);
+    return inside >= std::sqrt(double(DistanceSqr(a, b))) - 2.0;
+}
+
+// True when any part of the open path lies inside region.
+bool touches(const Path64& path, const Paths64& region) {
+    Clipper64 clipper;
+    Path64 closedLoop = path;
+    closedLoop.push_back(path.front());
+    clipper.AddOpenSubject({ closedLoop });
+    clipper.AddClip(region);
+    Paths64 closed, open;
+    clipper.Execute(ClipType::Intersection, FillRule::NonZero, closed, open);
+    return !open.empty();
+}
+
+// Starts the loop at a vertex inside the entry region, or else finds the
+// shortest straight lead-in from an entry vertex that stays in the component.
+bool placePlunge(Path64& loop, const Component& component, Point64& plunge) {
+    auto start = std::find_if(loop.begin(), loop.end(), [&](const Point64& p) { return inRegion(p, component.entry); });
+    if (start != loop.end()) {
+        std::rotate(loop.begin(), start, loop.end());
+        plunge = loop.front();
+        return true;
+    }
+
+    struct LeadIn {
+        double distance;
+        size_t vertex;
+        Point64 from;
+    };
+    std::vector<LeadIn> leadIns;
+    leadIns.reserve(loop.size());
+    for (size_t i = 0; i < loop.size(); ++i) {
+        LeadIn best{ -1.0, i, Point64() };
+        for (const auto& path : component.entry) {
+            for (const auto& p : path) {
+                double d = double(DistanceSqr(p, loop[i]));
+                if (best.distance < 0.0 || d < best.distance) best = { d, i, p };
+            }
+        }
+        if (best.distance >= 0.0) leadIns.push_back(best);
+    }
+    size_t tries = std::min(max_lead_in_tries, leadIns.size());
+    std::partial_sort(leadIns.begin(), leadIns.begin() + tries, leadIns.end(),
+                      [](const LeadIn& a, const LeadIn& b) { return a.distance < b.distance; });
+    for (size_t i = 0; i < tries; ++i) {
+        if (!segmentInside(leadIns[i].from, loop[leadIns[i].vertex], component.paths)) continue;
+        std::rotate(loop.begin(), loop.begin() + leadIns[i].vertex, loop.end());
+        plunge = leadIns[i].from;
+        return true;
+    }
+    return false;
+}
+
+// Appends each outer polygon of the tree with its holes.
+void collectComponents(const PolyPath64& node, std::vector<Component>& out) {
+    for (const auto& outer : node) {
+        Component component;
+        component.paths.push_back(outer->Polygon());
+        for (const auto& hole : *outer) component.paths.push_back(hole->Polygon());
+        out.push_back(std::move(component));
+        for (const auto& hole : *outer) collectComponents(*hole, out);
+    }
+}
+
+} // namespace
+
+UndercutSweep::UndercutSweep(double shaft_diameter, double head_diameter, const Rect64& bounds)
+    : stockBounds(bounds), shaftRadius(shaft_diameter / 2.0 * units_per_mm), headRadius(head_diameter / 2.0 * units_per_mm),
+      stock{ bounds.AsPath() } {}
+
+UndercutLayer UndercutSweep::step(const LayerRegion& layer) {
+    UndercutLayer out;
+    out.z = layer.z;
+
+    // Where the head centre can be: clear of the shaft's reach above and of
+    // the head's reach on this layer.
+    Paths64 headHit =
+        InflatePaths(layer.polygons, headRadius, JoinType::Round, EndType::Polygon, 2.0, 0.0, offset_threads);
+    if (!above.empty()) {
+        Clipper64 clipper;
+        clipper.AddSubject(stock);
+        clipper.AddClip(shaftBlocked);
+        clipper.AddClip(headHit);
+        PolyTree64 tree;
+        clipper.Execute(ClipType::Difference, FillRule::NonZero, tree);
+
+        // Keep the pieces the head can drop into.
+        std::vector<Component> components;
+        collectComponents(tree, components);
+        Paths64 reachable;
+        for (auto& component : components) {
+            component.entry = Difference(component.paths, headBlocked, FillRule::NonZero);
+            if (!component.entry.empty()) reachable.insert(reachable.end(), component.paths.begin(), component.paths.end());
+        }
+
+        // What the head sweeps that lies under material above.
+        Paths64 reach = InflatePaths(reachable, headRadius, JoinType::Round, EndType::Polygon, 2.0, 0.0, offset_threads);
+        Paths64 under = Intersect(reach, above, FillRule::NonZero);
+        under = InflatePaths(InflatePaths(under, -sliver_width, JoinType::Miter, EndType::Polygon, 2.0, 0.0, offset_threads),
+                             sliver_width, JoinType::Miter, EndType::Polygon, 2.0, 0.0, offset_threads);
+        out.undercut_area = toMm2(Area(under));
+
+        // Loops whose head sweep reaches into the undercut; the stock
+        // outline never does.
+        if (out.undercut_area > 0.0) {
+            Paths64 near = InflatePaths(under, headRadius + sliver_width, JoinType::Round, EndType::Polygon, 2.0, 0.0,
+                                        offset_threads);
+            for (const auto& component : components) {
+                if (component.entry.empty()) continue;
+                for (const auto& path : component.paths) {
+                    if (path.size() < 3 || GetBounds(path) == stockBounds || !touches(path, near)) continue;
+                    UndercutLoop loop;
+                    loop.loop = path;
+                    if (placePlunge(loop.loop, component, loop.plunge)) {
+                        out.loops.push_back(std::move(loop));
+                    } else {
+                        ++out.skipped_loops;
+                    }
+                }
+            }
+        }
+    }
+
+    above = Union(above, layer.polygons, FillRule::NonZero);
+    shaftBlocked = Union(shaftBlocked,
+                         InflatePaths(layer.polygons, shaftRadius, JoinType::Round, EndType::Polygon, 2.0, 0.0,
+                                      offset_threads),
+                         FillRule::NonZero);
+    headBlocked = Union(headBlocked, headHit, FillRule::NonZero);
+    return out;
+}
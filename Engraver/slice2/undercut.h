@@ -0,0 +1,54 @@
+// undercut.h
+// Top-down sweep for the T-slot head: what it can reach under the layers above
+
+#ifndef UNDERCUT_H
+#define UNDERCUT_H
+
+#include <cstddef>
+#include <vector>
+#include "clipper2/clipper.h"
+#include "layermodel.h"
+
+// A head centre path; the head plunges at plunge and moves in to loop[0]
+// (the two are the same point when the loop passes a plunge spot).
+struct UndercutLoop {
+    Clipper2Lib::Point64 plunge;
+    Clipper2Lib::Path64 loop;
+};
+
+struct UndercutLayer {
+    float z = 0.0f;
+    std::vector<UndercutLoop> loops;   // only loops along which the head cuts under material above
+    double undercut_area = 0.0;        // mm^2 the head cuts under material above; 0 means no T-slot pass is needed
+    size_t skipped_loops = 0;          // loops with no straight way in from a plunge spot
+};
+
+// Feed layers top first. The sweep keeps running unions of the material
+// above the current layer, as is and grown by the shaft and head radii, so
+// each step costs one layer's offsets and unions instead of redoing every
+// layer above it.
+//
+// At a layer, the head centre may go where the shaft clears everything
+// above and the head clears the layer itself. Parts of that region are only
+// reachable if the whole head can come down through the layers above
+// somewhere inside them. The head's height is taken as one layer.
+// Loops are kept only where the head reaches under material above; the rest
+// an end mill from above cuts anyway.
+class UndercutSweep {
+public:
+    // bounds: the stock outline, in layer units, that the tool can move in.
+    UndercutSweep(double shaft_diameter, double head_diameter, const Clipper2Lib::Rect64& bounds);
+
+    UndercutLayer step(const LayerRegion& layer);
+
+private:
+    Clipper2Lib::Rect64 stockBounds;
+    double shaftRadius;
+    double headRadius;
+    Clipper2Lib::Paths64 stock;
+    Clipper2Lib::Paths64 above;          // material of the layers fed so far
+    Clipper2Lib::Paths64 shaftBlocked;   // above grown by the shaft radius
+    Clipper2Lib::Paths64 headBlocked;    // above grown by the head radius
+};
+
+#endif // UNDERCUT_H
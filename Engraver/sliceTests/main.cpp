@@ -4,6 +4,8 @@
 #include <QApplication>
 #include <QOpenGLWidget>
 #include <QFileDialog>
+#include <QMouseEvent>
+#include <QWheelEvent>
 #include <QVector3D>
 #include <QSurfaceFormat>
 #include <QTimer>
@@ -11,9 +13,11 @@
 #include <vector>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
 #include <QFile>
 #include <QPainterPath>
 #include <QPolygonF>
+#include "layerrenderer.h"
 
 struct Triangle {
     QVector3D v0, v1, v2;
@@ -121,6 +125,19 @@ public:
             layers.push_back(sliceLayer(model, z));
         }
 
+        QVector3D lo(0, 0, 0), hi(0, 0, 0);
+        if (!model.empty()) {
+            lo = hi = model[0].v0;
+            for (const auto& tri : model) {
+                for (const QVector3D& v : { tri.v0, tri.v1, tri.v2 }) {
+                    lo = QVector3D(std::min(lo.x(), v.x()), std::min(lo.y(), v.y()), std::min(lo.z(), v.z()));
+                    hi = QVector3D(std::max(hi.x(), v.x()), std::max(hi.y(), v.y()), std::max(hi.z(), v.z()));
+                }
+            }
+        }
+        camera.fit(lo, hi);
+        layersDirty = true;
+
         QString gcode = generateGCode(layers, tool);
         QFile file("output.gcode");
         if (file.open(QIODevice::WriteOnly)) {
@@ -133,32 +150,50 @@ public:
 protected:
     void initializeGL() override {
         glClearColor(0.1f, 0.1f, 0.1f, 1);
+        renderer.initialize();
     }
     void resizeGL(int w, int h) override {
         glViewport(0, 0, w, h);
-        glMatrixMode(GL_PROJECTION);
-        glLoadIdentity();
-        float aspect = float(w) / float(h ? h : 1);
-        glOrtho(-100 * aspect, 100 * aspect, -100, 100, -1, 1);
-        glMatrixMode(GL_MODELVIEW);
+        aspect = float(w) / float(h ? h : 1);
     }
 
     void paintGL() override {
+        // The layers go to the vertex buffer once per model, in order, so
+        // every frame is a single draw call.
+        if (layersDirty) {
+            renderer.reset(layers.size());
+            for (size_t i = 0; i < layers.size(); ++i) renderer.addLayer(i, layers[i]);
+            renderer.upload();
+            layersDirty = false;
+        }
+
         glClear(GL_COLOR_BUFFER_BIT);
-        glLoadIdentity();
-        glColor3f(0, 1, 0);
-
-        glBegin(GL_LINES);
-        if (!layers.empty()) {
-            const auto& layer = layers.front();
-            for (size_t i = 0; i + 1 < layer.size(); i += 2) {
-                glVertex2f(layer[i].x(), layer[i].y());
-                glVertex2f(layer[i + 1].x(), layer[i + 1].y());
-            }
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(camera.projection(aspect).constData());
+        glMatrixMode(GL_MODELVIEW);
+        glLoadMatrixf(camera.view().constData());
+        if (!layers.empty()) renderer.draw(0, layers.size() - 1);
+    }
+
+    void mousePressEvent(QMouseEvent* event) override {
+        camera.press(event->pos());
+    }
+    void mouseMoveEvent(QMouseEvent* event) override {
+        if (event->buttons() & Qt::LeftButton) {
+            camera.drag(event->pos());
+            update();
         }
-        glEnd();
+    }
+    void wheelEvent(QWheelEvent* event) override {
+        camera.zoom(event->angleDelta().y());
+        update();
     }
 
+private:
+    LayerRenderer renderer;
+    OrbitCamera camera;
+    float aspect = 1.0f;
+    bool layersDirty = false;
 };
 
 int main(int argc, char** argv) {
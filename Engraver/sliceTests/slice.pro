@@ -15,10 +15,15 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# The renderer is slice2's own, so this app draws with what slice2 ships.
 SOURCES += \
-    main.cpp
+    main.cpp \
+    ../slice2/layerrenderer.cpp
 
 HEADERS += \
+    ../slice2/layerrenderer.h
+
+INCLUDEPATH += ../slice2
 
 FORMS += \
 
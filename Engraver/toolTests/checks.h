@@ -0,0 +1,24 @@
+// checks.h
+// A minimal check macro for the console test runner: a failed check prints
+// where it failed and is counted, and the run goes on.
+
+#ifndef CHECKS_H
+#define CHECKS_H
+
+#include <cstdio>
+
+int& checkFailures();
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);      \
+            ++checkFailures();                                                        \
+        }                                                                             \
+    } while (0)
+
+// One group of checks per tool; each runs its checks and prints its name.
+void runSliceChecks();
+void runClipperChecks();
+
+#endif // CHECKS_H
@@ -0,0 +1,126 @@
+// clippertests.cpp
+// greypocket's Clipper2 additions: tiled booleans and threaded offsets
+// against a single sweep
+
+#include "checks.h"
+#include "clipper2/clipper.h"
+#include "clipper2/clipper.tiled.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+// 'count' random ellipses over a 4 x 3 mm field, 64 vertices each, all
+// wound the same way unless 'holes', which reverses about a third.
+Paths64 randomEllipses(unsigned seed, int count, bool holes = false) {
+    std::mt19937 rng(seed);
+    Paths64 paths;
+    for (int k = 0; k < count; ++k) {
+        double cx = rng() % 400000, cy = rng() % 300000;
+        double a = 3000 + rng() % 40000, b = 3000 + rng() % 40000, turn = (rng() % 628) / 100.0;
+        Path64 path;
+        for (int j = 0; j < 64; ++j) {
+            double t = j * 2 * pi / 64, x = a * std::cos(t), y = b * std::sin(t);
+            path.emplace_back(static_cast<int64_t>(cx + x * std::cos(turn) - y * std::sin(turn)),
+                              static_cast<int64_t>(cy + x * std::sin(turn) + y * std::cos(turn)));
+        }
+        if (holes && rng() % 3 == 0) std::reverse(path.begin(), path.end());
+        paths.push_back(std::move(path));
+    }
+    return paths;
+}
+
+double perimeter(const Path64& path) {
+    double length = 0;
+    for (size_t i = 0, j = path.size() - 1; i < path.size(); j = i++) {
+        length += std::hypot(static_cast<double>(path[i].x - path[j].x), static_cast<double>(path[i].y - path[j].y));
+    }
+    return length;
+}
+
+// Same paths, compared by their areas: holes split at a seam, or outers
+// left apart there, change the count or the areas, while a crossing
+// rounded a unit differently moves an area by less than a unit along
+// the path's outline.
+bool samePaths(const Paths64& a, const Paths64& b) {
+    if (a.size() != b.size()) return false;
+    std::vector<std::pair<double, double>> areaA;
+    std::vector<double> areaB;
+    for (const Path64& path : a) areaA.emplace_back(Area(path), perimeter(path));
+    for (const Path64& path : b) areaB.push_back(Area(path));
+    std::sort(areaA.begin(), areaA.end());
+    std::sort(areaB.begin(), areaB.end());
+    for (size_t i = 0; i < areaA.size(); ++i) {
+        if (std::abs(areaA[i].first - areaB[i]) > areaA[i].second) return false;
+    }
+    return true;
+}
+
+// 300 ellipses over 16 tiles on 8 threads: every contour and hole that
+// crosses a seam has to come back as the one path a single sweep gives.
+void tiledMatchesSingleSweep() {
+    const ClipType ops[] = { ClipType::Intersection, ClipType::Union, ClipType::Difference };
+    const FillRule rules[] = { FillRule::NonZero, FillRule::Positive };
+    int mismatches = 0;
+    for (unsigned seed = 0; seed < 40; ++seed) {
+        Paths64 ellipses = randomEllipses(seed, 300);
+        Paths64 subjects(ellipses.begin(), ellipses.begin() + 200), clips(ellipses.begin() + 200, ellipses.end());
+        for (ClipType op : ops) {
+            for (FillRule rule : rules) {
+                Paths64 serial = BooleanOp(op, rule, subjects, clips);
+                Paths64 tiled = BooleanOpTiled(op, rule, subjects, clips, 8, 16);
+                if (!samePaths(serial, tiled)) ++mismatches;
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+// Same region, and wound the same way: a crossing rounded a unit
+// differently leaves at most a unit's width along the outlines. Paths
+// aren't compared one by one, as a hole pinched at a point may come back
+// as one path or two.
+bool sameRegion(const Paths64& a, const Paths64& b) {
+    double outline = 0;
+    for (const Path64& path : a) outline += perimeter(path);
+    return std::abs(Area(Xor(a, b, FillRule::NonZero))) <= outline &&
+           std::abs(Area(a) - Area(b)) <= outline;
+}
+
+// Offsets of overlapping ellipses with holes among them, grown and shrunk,
+// as paths and as a tree, on four threads against one.
+void threadedOffsetMatchesSerial() {
+    int mismatches = 0;
+    for (unsigned seed = 0; seed < 6; ++seed) {
+        Paths64 ellipses = randomEllipses(seed, 200, seed % 2 == 1);
+        for (double delta : { -1500.0, 2500.0 }) {
+            Paths64 serial, threaded;
+            PolyTree64 serialTree, threadedTree;
+            ClipperOffset offset;
+            offset.AddPaths(ellipses, JoinType::Round, EndType::Polygon);
+            offset.Execute(delta, serial);
+            offset.Execute(delta, serialTree);
+            offset.Threads(4);
+            offset.Execute(delta, threaded);
+            CHECK(offset.ErrorCode() == 0);
+            offset.Execute(delta, threadedTree);
+            CHECK(offset.ErrorCode() == 0);
+            if (!sameRegion(serial, threaded)) ++mismatches;
+            if (!sameRegion(PolyTreeToPaths64(serialTree), PolyTreeToPaths64(threadedTree))) ++mismatches;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+} // namespace
+
+void runClipperChecks() {
+    std::printf("clipper\n");
+    tiledMatchesSingleSweep();
+    threadedOffsetMatchesSerial();
+}
@@ -0,0 +1,17 @@
+// main.cpp
+// Runs the checks on the tools' geometry code; the exit code is the number
+// of failed checks, so a script or CI job can gate on it.
+
+#include "checks.h"
+
+int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+int main() {
+    runSliceChecks();
+    runClipperChecks();
+    std::printf("%d failed\n", checkFailures());
+    return checkFailures();
+}
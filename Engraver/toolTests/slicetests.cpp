@@ -0,0 +1,80 @@
+// slicetests.cpp
+// slice2: layer regions from slice segments
+
+#include "checks.h"
+#include "layergcode.h"
+#include "layermodel.h"
+#include <cmath>
+#include <sstream>
+#include <string>
+
+using namespace Clipper2Lib;
+
+namespace {
+
+// Segments as sliceLayer emits them, point pairs in mm.
+void addSegment(std::vector<QVector3D>& segments, float ax, float ay, float bx, float by) {
+    segments.emplace_back(ax, ay, 0.0f);
+    segments.emplace_back(bx, by, 0.0f);
+}
+
+// A 10 mm square, closed, plus an open chain A-B-C-D whose first segment is
+// the middle one, B-C. The open chain must come out whole and stay out of
+// the polygons instead of being closed into a triangle and a stray segment.
+void openChainSeededInTheMiddle() {
+    std::vector<QVector3D> segments;
+    addSegment(segments, 30, 0, 40, 0);   // B-C
+    addSegment(segments, 0, 0, 10, 0);
+    addSegment(segments, 10, 0, 10, 10);
+    addSegment(segments, 10, 10, 0, 10);
+    addSegment(segments, 0, 10, 0, 0);
+    addSegment(segments, 20, 5, 30, 0);   // A-B
+    addSegment(segments, 40, 0, 50, 5);   // C-D
+
+    LayerRegion layer = buildLayerRegion(segments, 0.0f);
+    CHECK(layer.polygons.size() == 1);
+    CHECK(!layer.polygons.empty() && std::abs(toMm2(Area(layer.polygons[0]))) == 100.0);
+    CHECK(layer.open_chains.size() == 1);
+    if (layer.open_chains.size() == 1) {
+        const Path64& chain = layer.open_chains[0];
+        CHECK(chain.size() == 4);
+        Point64 a = toUnits(PointD(20, 5)), d = toUnits(PointD(50, 5));
+        CHECK((chain.front() == a && chain.back() == d) || (chain.front() == d && chain.back() == a));
+    }
+}
+
+// The Z of every plunge ("G1 Z... F200") in a block of G-code.
+std::vector<std::string> plungeZ(const QString& code) {
+    std::vector<std::string> zs;
+    std::istringstream lines(code.toStdString());
+    for (std::string line; std::getline(lines, line);) {
+        if (line.rfind("G1 Z", 0) == 0 && line.find(" F200") != std::string::npos) zs.push_back(line.substr(3, line.find(' ', 3) - 3));
+    }
+    return zs;
+}
+
+// A layer's contour pass and its T-slot undercut pass must be cut at the
+// same height, below the model top by the layer's distance from it.
+void layerAndUndercutPassAtSameZ() {
+    const float top = 12.0f;
+    SlicedLayer layer;
+    layer.region.z = 4.0f;
+    layer.toolpath = { { PointD(0, 0), PointD(10, 0), PointD(10, 10), PointD(0, 10) } };
+    UndercutLayer under;
+    under.z = 4.0f;
+    under.loops.push_back({ toUnits(PointD(-5, 0)), toUnits(PathD{ PointD(-2, 0), PointD(12, 0), PointD(12, 12), PointD(-2, 12) }) });
+
+    std::vector<std::string> pass = plungeZ(layerGCode(layer, top));
+    std::vector<std::string> undercut = plungeZ(undercutGCode(under, top));
+    CHECK(pass.size() == 1 && undercut.size() == 1);
+    CHECK(pass == undercut);
+    CHECK(!pass.empty() && pass[0] == "Z-8");
+}
+
+} // namespace
+
+void runSliceChecks() {
+    std::printf("slice2\n");
+    openChainSeededInTheMiddle();
+    layerAndUndercutPassAtSameZ();
+}
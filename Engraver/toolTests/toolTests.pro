@@ -0,0 +1,49 @@
+QT       += core gui
+
+CONFIG += c++17
+CONFIG += console
+CONFIG -= app_bundle
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# The tools' own sources are compiled in, as in clipperbench, so what is
+# checked is what the tools run.
+SOURCES += \
+    slicetests.cpp \
+    clippertests.cpp \
+    main.cpp \
+    ../greypocket/clipper.engine.cpp \
+    ../greypocket/clipper.offset.cpp \
+    ../greypocket/clipper.rectclip.cpp \
+    ../greypocket/clipper.tiled.cpp \
+    ../slice2/layergcode.cpp \
+    ../slice2/layermodel.cpp
+
+HEADERS += \
+    checks.h \
+    ../greypocket/clipper2/clipper.tiled.h \
+    ../greypocket/fixedpoint.h \
+    ../slice2/layergcode.h \
+    ../slice2/layermodel.h \
+    ../slice2/layerstore.h \
+    ../slice2/undercut.h
+
+INCLUDEPATH += ../greypocket ../slice2
+
+FORMS += \
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+RESOURCES +=
+
+
+LIBS += -L/Users/macbook2015/Desktop/brew/lib
+
+INCLUDEPATH += /Users/macbook2015/Desktop/brew/include /Users/macbook2015/Desktop/brew/lib